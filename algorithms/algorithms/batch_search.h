@@ -0,0 +1,195 @@
+#ifndef INCLUDE_BATCH_SEARCH_H_
+#define INCLUDE_BATCH_SEARCH_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "case_fold.h"
+#include "failure_table.h"
+#include "trace.h"
+#include "work_stealing_pool.h"
+
+// Text scanned against a whole pattern group before moving on (stays in L1)
+const size_t BATCH_BLOCK_SIZE = 16 << 10;
+// Pattern bytes plus failure table entries per group (stays in L2)
+const size_t BATCH_GROUP_BYTES = 256 << 10;
+// Document range of one task; longer documents are split with an overlap
+const size_t BATCH_CHUNK_SIZE = 1 << 20;
+
+enum class TBatchEngine {
+    KnuthMorrisPratt,  // resumable KMP automaton per pattern
+    Filter             // SIMD first/middle/last byte filter of byteScan
+};
+
+struct TBatchMatch {
+    uint32_t document;
+    uint32_t pattern;
+    size_t position;
+
+    bool operator<(const TBatchMatch& other) const {
+        if (document != other.document)
+            return document < other.document;
+        if (pattern != other.pattern)
+            return pattern < other.pattern;
+        return position < other.position;
+    }
+
+    bool operator==(const TBatchMatch& other) const {
+        return document == other.document && pattern == other.pattern && position == other.position;
+    }
+};
+
+// Patterns compiled once for any number of batchSearch calls: every pattern
+// gets a compact failure table, and the patterns are cut into groups whose
+// tables fit into groupBytes (L2 by default) together
+class TPatternBatch {
+public:
+    explicit TPatternBatch(const std::vector<std::string>& patterns, size_t groupBytes = BATCH_GROUP_BYTES) {
+        size_t bytesInGroup = 0;
+        for (size_t k = 0; k < patterns.size(); ++k) {
+            _patterns.push_back(TCompiled{ patterns[k], TCompactFailureTable<uint32_t>(patterns[k]) });
+            const TCompiled& compiled = _patterns.back();
+            size_t bytes = compiled.pattern.size() + compiled.table.memoryUsage();
+            if (_groups.empty() || bytesInGroup + bytes > groupBytes) {
+                _groups.push_back(k);
+                bytesInGroup = 0;
+            }
+            bytesInGroup += bytes;
+        }
+        _groups.push_back(_patterns.size());
+    }
+
+    size_t size() const noexcept {
+        return _patterns.size();
+    }
+
+    size_t groups() const noexcept {
+        return _groups.size() - 1;
+    }
+
+    // Patterns [groupBegin(g), groupBegin(g + 1)) form group g
+    size_t groupBegin(size_t g) const noexcept {
+        return _groups[g];
+    }
+
+    std::string_view pattern(size_t k) const noexcept {
+        return _patterns[k].pattern;
+    }
+
+    // Longest pattern of group g
+    size_t groupMaxLength(size_t g) const noexcept {
+        size_t length = 0;
+        for (size_t k = _groups[g]; k < _groups[g + 1]; ++k)
+            length = std::max(length, _patterns[k].pattern.size());
+        return length;
+    }
+
+    // Feeds text (which starts at document offset `offset`) to the KMP automaton
+    // of pattern k in state j and returns the new state. Matches starting before
+    // ownEnd are reported as found(start); the state carries over to the next block.
+    template<typename Found>
+    size_t advance(size_t k, size_t j, std::string_view text, size_t offset, size_t ownEnd, Found found) const {
+        return compactKmpAdvance<false>(text, _patterns[k].pattern, _patterns[k].table, j, offset, [&](size_t start) {
+            if (start < ownEnd)
+                found(start);
+        });
+    }
+
+private:
+    struct TCompiled {
+        std::string pattern;
+        TCompactFailureTable<uint32_t> table;
+    };
+
+    std::vector<TCompiled> _patterns;
+    std::vector<size_t> _groups;  // first pattern of every group, then size()
+};
+
+// All matches of all patterns in all documents, sorted by document, pattern and position.
+//
+// Instead of streaming every document once per pattern, the work is tiled:
+// a task takes a document range of up to chunkSize bytes and one pattern
+// group, and walks the range in blocks of blockSize bytes, running every
+// pattern of the group over a block while it is in L1. Ranges and blocks
+// only report matches starting inside them and read up to the pattern
+// length - 1 bytes past their end; KMP instead keeps its states from block
+// to block. Tasks run on the work-stealing pool.
+//
+// Tiling pays off when the engine is faster than the cache level the
+// documents would otherwise stream from, as the SIMD filter is; KMP is
+// bound by its own dependency chain, and there the tiles mainly spread the
+// work over threads.
+inline std::vector<TBatchMatch> batchSearch(const std::vector<std::string>& documents, const TPatternBatch& patterns,
+                                            TWorkStealingPool& pool, TBatchEngine engine = TBatchEngine::Filter,
+                                            size_t blockSize = BATCH_BLOCK_SIZE, size_t chunkSize = BATCH_CHUNK_SIZE) {
+    struct TTile {
+        size_t document;
+        size_t begin;
+        size_t end;
+        size_t group;
+    };
+    std::vector<TTile> tiles;
+    blockSize = std::max<size_t>(blockSize, 1);
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    for (size_t d = 0; d < documents.size(); ++d) {
+        for (size_t begin = 0; begin < documents[d].size(); begin += chunkSize) {
+            for (size_t g = 0; g < patterns.groups(); ++g)
+                tiles.push_back({ d, begin, std::min(begin + chunkSize, documents[d].size()), g });
+        }
+    }
+
+    // Every tile writes only its own slot
+    std::vector<std::vector<TBatchMatch>> found(tiles.size());
+    for (size_t t = 0; t < tiles.size(); ++t) {
+        pool.submit([&, t] {
+            TRACE_SCOPE("scan");
+            const TTile& tile = tiles[t];
+            std::string_view document = documents[tile.document];
+            size_t first = patterns.groupBegin(tile.group);
+            size_t last = patterns.groupBegin(tile.group + 1);
+            size_t scanEnd = std::min(tile.end + patterns.groupMaxLength(tile.group) - 1, document.size());
+            auto report = [&](size_t k, size_t pos) {
+                found[t].push_back({ static_cast<uint32_t>(tile.document), static_cast<uint32_t>(k), pos });
+            };
+
+            if (engine == TBatchEngine::KnuthMorrisPratt) {
+                std::vector<size_t> states(last - first, 0);
+                for (size_t block = tile.begin; block < scanEnd; block += blockSize) {
+                    std::string_view text = document.substr(block, std::min(blockSize, scanEnd - block));
+                    for (size_t k = first; k < last; ++k) {
+                        states[k - first] = patterns.advance(k, states[k - first], text, block, tile.end,
+                                                             [&](size_t pos) { report(k, pos); });
+                    }
+                }
+                return;
+            }
+
+            for (size_t block = tile.begin; block < tile.end; block += blockSize) {
+                size_t blockEnd = std::min(block + blockSize, tile.end);
+                for (size_t k = first; k < last; ++k) {
+                    std::string_view pattern = patterns.pattern(k);
+                    if (pattern.empty())
+                        continue;
+                    size_t textEnd = std::min(blockEnd + pattern.size() - 1, document.size());
+                    byteScan<false>(document.substr(block, textEnd - block), pattern, [&](size_t i) {
+                        if (block + i < blockEnd)
+                            report(k, block + i);
+                    });
+                }
+            }
+        });
+    }
+    pool.wait();
+
+    std::vector<TBatchMatch> matches;
+    for (const std::vector<TBatchMatch>& part : found)
+        matches.insert(matches.end(), part.begin(), part.end());
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+#endif  // INCLUDE_BATCH_SEARCH_H_
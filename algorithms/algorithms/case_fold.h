@@ -0,0 +1,188 @@
+#ifndef INCLUDE_CASE_FOLD_H_
+#define INCLUDE_CASE_FOLD_H_
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "trace.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CASE_FOLD_SSE2
+#endif
+
+// ASCII case folding: 'A'..'Z' become 'a'..'z', every other byte (including
+// all bytes of UTF-8 multibyte sequences) stays as it is
+inline unsigned char foldAscii(unsigned char c) {
+    return static_cast<unsigned char>(c - 'A') < 26 ? static_cast<unsigned char>(c | 0x20) : c;
+}
+
+inline bool isUtf8Continuation(unsigned char c) {
+    return (c & 0xC0) == 0x80;
+}
+
+// Number of characters starting in s[0..length): bytes that are not 10xxxxxx
+inline size_t countCodepoints(const unsigned char* s, size_t length) {
+    size_t count = 0;
+    size_t i = 0;
+#ifdef CASE_FOLD_SSE2
+    // Continuation bytes are exactly the signed values -128..-65. Every byte of
+    // `ones` counts up to 255 starts before it is summed with _mm_sad_epu8.
+    const __m128i limit = _mm_set1_epi8(-65);
+    while (i + 16 <= length) {
+        __m128i ones = _mm_setzero_si128();
+        for (size_t step = 0; step < 255 && i + 16 <= length; ++step, i += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            ones = _mm_sub_epi8(ones, _mm_cmpgt_epi8(bytes, limit));
+        }
+        __m128i sums = _mm_sad_epu8(ones, _mm_setzero_si128());
+        count += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+    }
+#endif
+    for (; i < length; ++i)
+        count += !isUtf8Continuation(s[i]);
+    return count;
+}
+
+#ifdef CASE_FOLD_SSE2
+// Folds 16 bytes at once: c + 0x20 where c is in 'A'..'Z'
+inline __m128i foldAscii16(__m128i bytes) {
+    // Shift 'A'..'Z' to -128..-103 so one signed compare finds them
+    __m128i shifted = _mm_add_epi8(bytes, _mm_set1_epi8(static_cast<char>(128 - 'A')));
+    __m128i upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+    return _mm_or_si128(bytes, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+#endif
+
+// Calls found(i) for every window i equal to the pattern, byte for byte or,
+// with ignoreCase, after ASCII folding. The text is never copied: 16 windows
+// at a time are filtered by comparing their first, middle and last bytes with
+// the pattern's (case-folded in registers), and only the candidates are
+// compared in full.
+template<bool IgnoreCase, typename Found>
+void byteScan(std::string_view text, std::string_view pattern, Found found) {
+    size_t n = text.size();
+    size_t m = pattern.size();
+    if (m == 0 || m > n) {
+        return;
+    }
+    const unsigned char* t = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(pattern.data());
+    auto fold = [](unsigned char c) { return IgnoreCase ? foldAscii(c) : c; };
+    auto matchesAt = [&](size_t i) {
+        for (size_t j = 0; j < m; ++j) {
+            if (fold(t[i + j]) != fold(p[j]))
+                return false;
+        }
+        return true;
+    };
+
+    size_t windows = n - m + 1;
+    size_t i = 0;
+#ifdef CASE_FOLD_SSE2
+    // A byte c equals letter L up to case exactly when (c | 0x20) == lower(L),
+    // so the probes only set the case bit, and only where the pattern has a letter
+    auto caseBit = [&](unsigned char c) {
+        bool letter = static_cast<unsigned char>((c | 0x20) - 'a') < 26;
+        return _mm_set1_epi8(IgnoreCase && letter ? 0x20 : 0);
+    };
+    const __m128i first = _mm_set1_epi8(static_cast<char>(fold(p[0])));
+    const __m128i middle = _mm_set1_epi8(static_cast<char>(fold(p[m / 2])));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(fold(p[m - 1])));
+    const __m128i firstBit = caseBit(p[0]);
+    const __m128i middleBit = caseBit(p[m / 2]);
+    const __m128i lastBit = caseBit(p[m - 1]);
+
+    // Patterns of up to 16 bytes are verified with one compare of a folded block
+    unsigned char block[16] = { 0 };
+    for (size_t j = 0; j < m && j < 16; ++j)
+        block[j] = fold(p[j]);
+    const __m128i patternBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+    const unsigned blockMask = m < 16 ? (1u << m) - 1 : 0xFFFFu;
+    auto verify = [&](size_t at) {
+        if (m > 16 || at + 16 > n)
+            return matchesAt(at);
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t + at));
+        if (IgnoreCase)
+            bytes = foldAscii16(bytes);
+        unsigned equal = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, patternBlock)));
+        return (equal & blockMask) == blockMask;
+    };
+
+    for (; i + 16 <= windows; i += 16) {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t + i));
+        __m128i center = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t + i + m / 2));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t + i + m - 1));
+        if (IgnoreCase) {
+            head = _mm_or_si128(head, firstBit);
+            center = _mm_or_si128(center, middleBit);
+            tail = _mm_or_si128(tail, lastBit);
+        }
+        __m128i hits = _mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(hits, _mm_cmpeq_epi8(center, middle))));
+        while (mask) {
+            unsigned bit = 0;
+            while (!(mask & (1u << bit)))
+                ++bit;
+            mask &= mask - 1;
+            if (verify(i + bit))
+                found(i + bit);
+        }
+    }
+#endif
+    for (; i < windows; ++i) {
+        if (fold(t[i]) == fold(p[0]) && matchesAt(i))
+            found(i);
+    }
+}
+
+// Byte offsets of all matches; ignoreCase folds ASCII letters only.
+// Matches are appended to positions: a vector<int> or a TOccurrenceSet.
+template<typename Positions>
+void byteSearchInto(std::string_view text, std::string_view pattern, bool ignoreCase, Positions& positions) {
+    TRACE_SCOPE("scan");
+    auto found = [&](size_t i) { positions.push_back(static_cast<int>(i)); };
+    if (ignoreCase)
+        byteScan<true>(text, pattern, found);
+    else
+        byteScan<false>(text, pattern, found);
+}
+
+inline std::vector<int> byteSearch(std::string_view text, std::string_view pattern, bool ignoreCase) {
+    std::vector<int> positions;
+    byteSearchInto(text, pattern, ignoreCase, positions);
+    return positions;
+}
+
+// Search in UTF-8 text reporting codepoint offsets. A match must start and end
+// on character boundaries, so a pattern never matches part of a multibyte
+// sequence. ignoreCase folds ASCII letters; other characters match exactly.
+template<typename Positions>
+void utf8SearchInto(std::string_view text, std::string_view pattern, bool ignoreCase, Positions& positions) {
+    TRACE_SCOPE("scan");
+    const unsigned char* t = reinterpret_cast<const unsigned char*>(text.data());
+    size_t m = pattern.size();
+    size_t counted = 0;     // bytes of the text already converted
+    size_t codepoints = 0;  // characters starting before `counted`
+
+    auto found = [&](size_t i) {
+        if (isUtf8Continuation(t[i]) || (i + m < text.size() && isUtf8Continuation(t[i + m])))
+            return;
+        codepoints += countCodepoints(t + counted, i - counted);
+        counted = i;
+        positions.push_back(static_cast<int>(codepoints));
+    };
+    if (ignoreCase)
+        byteScan<true>(text, pattern, found);
+    else
+        byteScan<false>(text, pattern, found);
+}
+
+inline std::vector<int> utf8Search(std::string_view text, std::string_view pattern, bool ignoreCase) {
+    std::vector<int> positions;
+    utf8SearchInto(text, pattern, ignoreCase, positions);
+    return positions;
+}
+
+#endif  // INCLUDE_CASE_FOLD_H_
@@ -0,0 +1,252 @@
+#ifndef INCLUDE_COMPRESSED_TEXT_H_
+#define INCLUDE_COMPRESSED_TEXT_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Maximal block of equal characters
+struct TRun {
+    char symbol;
+    size_t length;
+
+    bool operator==(const TRun& other) const noexcept {
+        return symbol == other.symbol && length == other.length;
+    }
+};
+
+// Run-length encoded string. Adjacent runs always hold different symbols,
+// which the search below relies on.
+class TRunLengthString {
+public:
+    TRunLengthString() : _size(0) {}
+
+    explicit TRunLengthString(const std::string& text) : _size(0) {
+        for (char c : text) {
+            append(c, 1);
+        }
+    }
+
+    // Appends `count` copies of `symbol` without materializing them
+    void append(char symbol, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        if (!_runs.empty() && _runs.back().symbol == symbol) {
+            _runs.back().length += count;
+        }
+        else {
+            _starts.push_back(_size);
+            _runs.push_back({ symbol, count });
+        }
+        _size += count;
+    }
+
+    // Appends `times` copies of another encoded string
+    void appendRepeated(const TRunLengthString& block, size_t times) {
+        for (size_t i = 0; i < times; ++i) {
+            for (const TRun& run : block._runs) {
+                append(run.symbol, run.length);
+            }
+        }
+    }
+
+    size_t size() const noexcept {
+        return _size;
+    }
+
+    const std::vector<TRun>& runs() const noexcept {
+        return _runs;
+    }
+
+    // Offset of the first character of run r in the decoded string
+    size_t runStart(size_t r) const {
+        return _starts[r];
+    }
+
+    char operator[](size_t ind) const {
+        if (ind >= _size) {
+            throw std::out_of_range("Index out of range");
+        }
+        size_t r = std::upper_bound(_starts.begin(), _starts.end(), ind) - _starts.begin() - 1;
+        return _runs[r].symbol;
+    }
+
+    std::string expand() const {
+        std::string result;
+        result.reserve(_size);
+        for (const TRun& run : _runs) {
+            result.append(run.length, run.symbol);
+        }
+        return result;
+    }
+
+private:
+    std::vector<TRun> _runs;
+    std::vector<size_t> _starts;
+    size_t _size;
+};
+
+// Virtual string `base` repeated `repetitions` times
+class TPeriodicString {
+public:
+    TPeriodicString(const std::string& base, size_t repetitions) : _base(base), _repetitions(repetitions) {
+        if (base.empty())
+            throw std::length_error("Period should be non-empty");
+    }
+
+    size_t size() const noexcept {
+        return _base.size() * _repetitions;
+    }
+
+    const std::string& base() const noexcept {
+        return _base;
+    }
+
+    char operator[](size_t ind) const {
+        if (ind >= size()) {
+            throw std::out_of_range("Index out of range");
+        }
+        return _base[ind % _base.size()];
+    }
+
+    std::string expand() const {
+        std::string result;
+        result.reserve(size());
+        for (size_t i = 0; i < _repetitions; ++i) {
+            result += _base;
+        }
+        return result;
+    }
+
+private:
+    std::string _base;
+    size_t _repetitions;
+};
+
+// Knuth-Morris-Pratt over any random-access sequence whose elements support ==.
+// Calls found(i) for every occurrence of pattern in text starting at index i.
+template<typename Sequence, typename Found>
+void compressedKmp(const Sequence& text, size_t n, const Sequence& pattern, size_t m, Found found) {
+    if (m == 0 || m > n) {
+        return;
+    }
+    std::vector<size_t> fY(m, 0);
+    for (size_t i = 1, j = 0; i < m; ++i) {
+        while (j > 0 && !(pattern[i] == pattern[j])) {
+            j = fY[j - 1];
+        }
+        if (pattern[i] == pattern[j]) {
+            j++;
+        }
+        fY[i] = j;
+    }
+    for (size_t i = 0, j = 0; i < n; ++i) {
+        while (j > 0 && !(text[i] == pattern[j])) {
+            j = fY[j - 1];
+        }
+        if (text[i] == pattern[j]) {
+            j++;
+        }
+        if (j == m) {
+            found(i - m + 1);
+            j = fY[j - 1];
+        }
+    }
+}
+
+// Occurrences of pattern in a run-length encoded text in O(runs(text) + runs(pattern) + occ).
+// The inner runs of the pattern must equal text runs exactly; the first and the last
+// pattern runs only need a text run of the same symbol that is at least as long.
+// Matches are appended to positions: a vector<size_t> or a TOccurrenceSet.
+template<typename Positions>
+void searchRunLengthInto(const TRunLengthString& text, const std::string& patternText, Positions& positions) {
+    TRunLengthString pattern(patternText);
+    const std::vector<TRun>& T = text.runs();
+    const std::vector<TRun>& P = pattern.runs();
+    size_t k = P.size();
+    if (k == 0 || pattern.size() > text.size()) {
+        return;
+    }
+
+    if (k == 1) {
+        for (size_t r = 0; r < T.size(); ++r) {
+            if (T[r].symbol == P[0].symbol && T[r].length >= P[0].length) {
+                for (size_t i = 0; i + P[0].length <= T[r].length; ++i) {
+                    positions.push_back(text.runStart(r) + i);
+                }
+            }
+        }
+        return;
+    }
+
+    auto fits = [&](size_t r, const TRun& run) {
+        return T[r].symbol == run.symbol && T[r].length >= run.length;
+    };
+    auto check = [&](size_t first) {
+        // `first` is the text run matching P[1]
+        size_t last = first + k - 2;
+        if (first >= 1 && last < T.size() && fits(first - 1, P[0]) && fits(last, P[k - 1])) {
+            positions.push_back(text.runStart(first) - P[0].length);
+        }
+    };
+
+    if (k == 2) {
+        for (size_t r = 1; r < T.size(); ++r) {
+            check(r);
+        }
+    }
+    else {
+        std::vector<TRun> middle(P.begin() + 1, P.end() - 1);
+        compressedKmp(T, T.size(), middle, middle.size(), check);
+    }
+}
+
+inline std::vector<size_t> searchRunLength(const TRunLengthString& text, const std::string& pattern) {
+    std::vector<size_t> positions;
+    searchRunLengthInto(text, pattern, positions);
+    return positions;
+}
+
+// Occurrences of pattern in base^repetitions in O(|base| + m + occ). Since the text
+// has period |base|, a window starting at i matches iff the window starting at
+// i mod |base| does, so only one period (plus m characters) is ever scanned.
+template<typename Positions>
+void searchPeriodicInto(const TPeriodicString& text, const std::string& pattern, Positions& positions) {
+    size_t n = text.size();
+    size_t m = pattern.size();
+    size_t p = text.base().size();
+    if (m == 0 || m > n) {
+        return;
+    }
+
+    std::string window;
+    while (window.size() < std::min(n, m + p - 1)) {
+        window += text.base();
+    }
+    std::vector<size_t> residues;
+    compressedKmp(window, window.size(), pattern, m, [&](size_t i) {
+        if (i < p) {
+            residues.push_back(i);
+        }
+    });
+
+    for (size_t offset = 0; offset + m <= n; offset += p) {
+        for (size_t r : residues) {
+            if (offset + r + m > n) {
+                break;
+            }
+            positions.push_back(offset + r);
+        }
+    }
+}
+
+inline std::vector<size_t> searchPeriodic(const TPeriodicString& text, const std::string& pattern) {
+    std::vector<size_t> positions;
+    searchPeriodicInto(text, pattern, positions);
+    return positions;
+}
+
+#endif  // INCLUDE_COMPRESSED_TEXT_H_
@@ -0,0 +1,176 @@
+#ifndef INCLUDE_FAILURE_TABLE_H_
+#define INCLUDE_FAILURE_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "trace.h"
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#define FAILURE_TABLE_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#elif defined(__GNUC__)
+#define FAILURE_TABLE_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define FAILURE_TABLE_PREFETCH(address) ((void)0)
+#endif
+
+// Knuth-Morris-Pratt failure table (fY[i] = longest proper border of
+// pattern[0..i]) with entries of type Entry, which only has to hold values
+// below the pattern length.
+//
+// If the pattern has smallest period p and is at least 2p long, then for
+// every i >= 2p - 1 the prefix pattern[0..i] also has smallest period p
+// (a smaller one would give the whole pattern a period gcd < p by Fine and
+// Wilf), so fY[i] = i + 1 - p. Only the entries up to the first prefix where
+// that is detected are stored; the rest is computed from the period.
+template<typename Entry>
+class TCompactFailureTable {
+public:
+    explicit TCompactFailureTable(std::string_view pattern) : _length(pattern.size()), _period(0) {
+        if (_length == 0)
+            return;
+        TRACE_SCOPE("preprocess");
+        _entries.push_back(0);
+        size_t j = 0;
+        size_t nextCheck = 0;
+
+        for (size_t i = 1; i < _length; ++i) {
+            while (j > 0 && pattern[i] != pattern[j]) {
+                j = _entries[j - 1];
+                // The next test reads pattern[j]; if it fails, _entries[j - 1]
+                // follows - fetch it now so the two misses overlap
+                if (j > 0)
+                    FAILURE_TABLE_PREFETCH(&_entries[j - 1]);
+            }
+            if (pattern[i] == pattern[j]) {
+                j++;
+            }
+            _entries.push_back(static_cast<Entry>(j));
+
+            // The prefix so far spans two periods: see whether the rest keeps the period.
+            // A failed check is not repeated before its mismatch, which keeps this O(m).
+            size_t period = i + 1 - j;
+            if (2 * period <= i + 1 && i >= nextCheck) {
+                size_t k = i + 1;
+                while (k < _length && pattern[k] == pattern[k - period]) {
+                    ++k;
+                }
+                if (k == _length) {
+                    _period = period;
+                    break;
+                }
+                nextCheck = k;
+            }
+        }
+        _entries.shrink_to_fit();
+    }
+
+    size_t operator[](size_t i) const {
+        return i < _entries.size() ? _entries[i] : i + 1 - _period;
+    }
+
+    size_t size() const noexcept {
+        return _length;
+    }
+
+    // Smallest period used for the implicit tail, 0 if the whole table is stored
+    size_t period() const noexcept {
+        return _period;
+    }
+
+    size_t stored() const noexcept {
+        return _entries.size();
+    }
+
+    // Address of entry i if it is stored (for prefetching), nullptr otherwise
+    const Entry* address(size_t i) const noexcept {
+        return i < _entries.size() ? &_entries[i] : nullptr;
+    }
+
+    size_t memoryUsage() const noexcept {
+        return _entries.capacity() * sizeof(Entry);
+    }
+
+private:
+    std::vector<Entry> _entries;
+    size_t _length;
+    size_t _period;
+};
+
+// Resumable KMP over a prebuilt table: feeds text, which starts at offset
+// `offset` of the whole input, to the automaton in state j and returns the new
+// state, so a text can be fed block by block. Calls found(start) for every
+// match with its start in the whole input; a match may start in an earlier block.
+// A failure link j -> table[j - 1] is followed by a read of pattern[j] and,
+// when that mismatches too, of table[j - 1] at the new j. Both are far apart
+// in a long pattern; with Prefetch the table entry is requested right after
+// the jump, so its miss overlaps the one on the pattern instead of following
+// it. The next link itself depends on that entry and cannot be fetched earlier.
+template<bool Prefetch = true, typename Entry, typename Found>
+size_t compactKmpAdvance(std::string_view text, std::string_view pattern, const TCompactFailureTable<Entry>& table,
+                         size_t j, size_t offset, Found found) {
+    size_t m = pattern.size();
+    if (m == 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < text.size(); i++) {
+        while (j > 0 && text[i] != pattern[j]) {
+            j = table[j - 1];
+            if (Prefetch && j > 0) {
+                const Entry* next = table.address(j - 1);
+                if (next)
+                    FAILURE_TABLE_PREFETCH(next);
+            }
+        }
+        if (text[i] == pattern[j]) {
+            j++;
+        }
+        if (j == m) {
+            found(offset + i + 1 - m);
+            j = table[j - 1];
+        }
+    }
+    return j;
+}
+
+// KMP scan over a prebuilt table; calls found(i) for every match at offset i
+template<bool Prefetch = true, typename Entry, typename Found>
+void compactKmpScan(std::string_view text, std::string_view pattern, const TCompactFailureTable<Entry>& table, Found found) {
+    size_t n = text.size();
+    size_t m = pattern.size();
+    if (m == 0 || m > n) {
+        return;
+    }
+
+    TRACE_SCOPE("scan");
+    compactKmpAdvance<Prefetch>(text, pattern, table, 0, 0, found);
+}
+
+// KMP with the narrowest entry width the pattern length allows (8, 16 or 32 bits)
+template<bool Prefetch = true, typename Found>
+void compactKmp(std::string_view text, std::string_view pattern, Found found) {
+    size_t m = pattern.size();
+    if (m == 0 || m > text.size()) {
+        return;
+    }
+    if (m <= UINT8_MAX) {
+        compactKmpScan<Prefetch>(text, pattern, TCompactFailureTable<uint8_t>(pattern), found);
+    }
+    else if (m <= UINT16_MAX) {
+        compactKmpScan<Prefetch>(text, pattern, TCompactFailureTable<uint16_t>(pattern), found);
+    }
+    else {
+        compactKmpScan<Prefetch>(text, pattern, TCompactFailureTable<uint32_t>(pattern), found);
+    }
+}
+
+inline std::vector<int> compactKnuthMorrisPratt(std::string_view text, std::string_view pattern) {
+    std::vector<int> positions;
+    compactKmp(text, pattern, [&](size_t i) { positions.push_back(static_cast<int>(i)); });
+    return positions;
+}
+
+#endif  // INCLUDE_FAILURE_TABLE_H_
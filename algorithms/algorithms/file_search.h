@@ -0,0 +1,146 @@
+#ifndef INCLUDE_FILE_SEARCH_H_
+#define INCLUDE_FILE_SEARCH_H_
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "trace.h"
+#include "work_stealing_pool.h"
+
+// Default amount of text handed to one search task
+const size_t FILE_SEARCH_CHUNK_SIZE = 4 << 20;
+
+// Matches found in one file. Positions are byte offsets from the start of the file.
+struct TFileMatches {
+    std::string path;
+    std::vector<size_t> positions;
+    std::string error;  // empty unless the file could not be read
+};
+
+// Expands the given paths into the list of regular files below them (directories
+// are walked recursively), sorted so the output order does not depend on the file system
+inline std::vector<std::string> collectFiles(const std::vector<std::string>& roots) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+
+    for (const std::string& root : roots) {
+        std::error_code ec;
+        if (fs::is_regular_file(root, ec)) {
+            files.push_back(root);
+            continue;
+        }
+        if (!fs::is_directory(root, ec)) {
+            continue;
+        }
+        fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            std::error_code typeError;
+            if (it->is_regular_file(typeError)) {
+                files.push_back(it->path().string());
+            }
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    return files;
+}
+
+// Reads `length` bytes starting at `offset`; returns false if the file cannot be read
+inline bool readFileRange(const std::string& path, size_t offset, size_t length, std::string& out) {
+    TRACE_SCOPE("load");
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    out.resize(length);
+    file.seekg(offset);
+    file.read(&out[0], length);
+    return static_cast<size_t>(file.gcount()) == length;
+}
+
+// Searches every file for the pattern on the pool. Each file becomes one task;
+// files larger than chunkSize are split by that task into chunk tasks which
+// overlap by pattern.size() - 1 bytes, so idle workers can steal pieces of a
+// large file instead of waiting for it. `search` is any engine with the
+// signature std::vector<int>(const std::string& text, const std::string& pattern).
+template<typename Search>
+std::vector<TFileMatches> searchFiles(const std::vector<std::string>& paths, const std::string& pattern,
+                                      Search search, TWorkStealingPool& pool,
+                                      size_t chunkSize = FILE_SEARCH_CHUNK_SIZE) {
+    std::vector<TFileMatches> results(paths.size());
+    if (pattern.empty()) {
+        for (size_t f = 0; f < paths.size(); ++f) {
+            results[f].path = paths[f];
+        }
+        return results;
+    }
+    chunkSize = std::max(chunkSize, pattern.size());
+
+    // chunkMatches[f][c] holds chunk c of file f, each slot written by exactly one task
+    std::vector<std::vector<std::vector<int>>> chunkMatches(paths.size());
+    std::unique_ptr<std::atomic<bool>[]> failed(new std::atomic<bool>[paths.size()]());
+
+    for (size_t f = 0; f < paths.size(); ++f) {
+        results[f].path = paths[f];
+        pool.submit([&, f] {
+            std::error_code ec;
+            size_t fileSize = static_cast<size_t>(std::filesystem::file_size(paths[f], ec));
+            if (ec) {
+                failed[f] = true;
+                return;
+            }
+            if (fileSize < pattern.size()) {
+                return;
+            }
+
+            size_t chunks = (fileSize - pattern.size()) / chunkSize + 1;
+            chunkMatches[f].resize(chunks);
+            for (size_t c = 0; c < chunks; ++c) {
+                auto scanChunk = [&, f, c, fileSize] {
+                    size_t start = c * chunkSize;
+                    size_t length = std::min(chunkSize + pattern.size() - 1, fileSize - start);
+                    std::string text;
+                    if (!readFileRange(paths[f], start, length, text)) {
+                        failed[f] = true;
+                        return;
+                    }
+                    std::vector<int> found = search(text, pattern);
+                    // Matches starting past the owned range belong to the next chunk
+                    found.erase(std::partition_point(found.begin(), found.end(),
+                                                     [&](int pos) { return static_cast<size_t>(pos) < chunkSize; }),
+                                found.end());
+                    chunkMatches[f][c] = std::move(found);
+                };
+                if (c + 1 == chunks) {
+                    scanChunk();
+                }
+                else {
+                    pool.submit(scanChunk);
+                }
+            }
+        });
+    }
+    pool.wait();
+
+    for (size_t f = 0; f < paths.size(); ++f) {
+        if (failed[f]) {
+            results[f].error = "Cannot open " + paths[f];
+            continue;
+        }
+        for (size_t c = 0; c < chunkMatches[f].size(); ++c) {
+            for (int pos : chunkMatches[f][c]) {
+                results[f].positions.push_back(c * chunkSize + pos);
+            }
+        }
+    }
+    return results;
+}
+
+#endif  // INCLUDE_FILE_SEARCH_H_
@@ -4,29 +4,44 @@
 #include <vector>
 #include <chrono>
 
+#include "case_fold.h"
+#include "file_search.h"
+#include "occurrence_set.h"
+#include "rabin_karp_simd.h"
+#include "sharded_search.h"
+#include "trace.h"
+#include "wildcard_search.h"
+
 using namespace std;
 using namespace chrono;
 
-// Function to perform the Rabin-Karp search algorithm
-vector<int> rabinKarp(const string& text, const string& pattern) {
-    vector<int> positions;
+// Function to perform the Rabin-Karp search algorithm.
+// Matches are appended to positions: a vector<int> or a TOccurrenceSet.
+template<typename Positions>
+void rabinKarpInto(const string& text, const string& pattern, Positions& positions) {
     int m = pattern.size();
     int n = text.size();
     int base = 256;
     int prime = 101;
     int patternHash = 0, textHash = 0, h = 1;
 
-    for (int i = 0; i < m - 1; i++) {
-        h = (h * base) % prime;
-    }
+    {
+        TRACE_SCOPE("preprocess");
+        for (int i = 0; i < m - 1; i++) {
+            h = (h * base) % prime;
+        }
 
-    for (int i = 0; i < m; i++) {
-        patternHash = (base * patternHash + pattern[i]) % prime;
-        textHash = (base * textHash + text[i]) % prime;
+        for (int i = 0; i < m; i++) {
+            patternHash = (base * patternHash + static_cast<unsigned char>(pattern[i])) % prime;
+            textHash = (base * textHash + static_cast<unsigned char>(text[i])) % prime;
+        }
     }
 
+    TRACE_SCOPE("scan");
+    TTraceTotal verify("verify");
     for (int i = 0; i <= n - m; i++) {
         if (patternHash == textHash) {
+            verify.start();
             bool match = true;
             for (int j = 0; j < m; j++) {
                 if (text[i + j] != pattern[j]) {
@@ -34,17 +49,23 @@ vector<int> rabinKarp(const string& text, const string& pattern) {
                     break;
                 }
             }
+            verify.stop();
             if (match) {
                 positions.push_back(i);
             }
         }
         if (i < n - m) {
-            textHash = (base * (textHash - text[i] * h) + text[i + m]) % prime;
+            textHash = (base * (textHash - static_cast<unsigned char>(text[i]) * h) + static_cast<unsigned char>(text[i + m])) % prime;
             if (textHash < 0) {
                 textHash += prime;
             }
         }
     }
+}
+
+vector<int> rabinKarp(const string& text, const string& pattern) {
+    vector<int> positions;
+    rabinKarpInto(text, pattern, positions);
     return positions;
 }
 
@@ -65,19 +86,23 @@ void buildPrefixTable(const string& pattern, vector<int>& fY) {
     }
 }
 
-// Knuth-Morris-Pratt search algorithm
-vector<int> knuthMorrisPratt(const string& text, const string& pattern) {
-    vector<int> positions;
+// Knuth-Morris-Pratt search algorithm; positions is a vector<int> or a TOccurrenceSet
+template<typename Positions>
+void knuthMorrisPrattInto(const string& text, const string& pattern, Positions& positions) {
     int n = text.size();
     int m = pattern.size();
 
     if (m == 0 || n == 0 || m > n) {
-        return positions; // No valid search possible
+        return; // No valid search possible
     }
 
     vector<int> fY(m, 0);
-    buildPrefixTable(pattern, fY);
+    {
+        TRACE_SCOPE("preprocess");
+        buildPrefixTable(pattern, fY);
+    }
 
+    TRACE_SCOPE("scan");
     int j = 0;
     for (int i = 0; i < n; i++) {
         while (j > 0 && text[i] != pattern[j]) {
@@ -91,11 +116,32 @@ vector<int> knuthMorrisPratt(const string& text, const string& pattern) {
             j = fY[j - 1];
         }
     }
+}
 
+vector<int> knuthMorrisPratt(const string& text, const string& pattern) {
+    vector<int> positions;
+    knuthMorrisPrattInto(text, pattern, positions);
     return positions;
 }
 
+void writePositions(ofstream& outputFile, const vector<int>& positions) {
+    for (int pos : positions) {
+        outputFile << pos << " ";
+    }
+    outputFile << endl;
+}
+
+void writePositions(ofstream& outputFile, const TOccurrenceSet& positions) {
+    positions.forEach([&](size_t pos) { outputFile << pos << " "; });
+    outputFile << endl;
+    outputFile << "Occurrence set: " << positions.size() << " matches in " << positions.memoryUsage() << " bytes" << endl;
+}
+
+// Positions is the output of every searcher: vector<int>, or TOccurrenceSet
+// with the --occurrence-set option
+template<typename Positions>
 void writeResults(const string& algorithmName, const string& text, const string& pattern) {
+    TRACE_SCOPE(algorithmName);
     string outputFileName = "output_" + algorithmName + ".txt";
     ofstream outputFile(outputFileName);
 
@@ -104,16 +150,77 @@ void writeResults(const string& algorithmName, const string& text, const string&
         return;
     }
 
-    vector<int> positions;
+    Positions positions;
+    auto start = high_resolution_clock::now();
+
+    if (algorithmName == "Rabin-Karp") {
+        outputFile << "Algorithm: Rabin-Karp" << endl;
+        rabinKarpInto(text, pattern, positions);
+    }
+    else if (algorithmName == "Knuth-Morris-Pratt") {
+        outputFile << "Algorithm: Knuth-Morris-Pratt" << endl;
+        knuthMorrisPrattInto(text, pattern, positions);
+    }
+    else if (algorithmName == "Rabin-Karp-SIMD") {
+        outputFile << "Algorithm: Rabin-Karp-SIMD" << endl;
+        rabinKarpSimdInto(text, pattern, positions);
+    }
+    else if (algorithmName == "Wildcard-NTT") {
+        outputFile << "Algorithm: Wildcard-NTT ('?' matches any character)" << endl;
+        wildcardSearchInto(text, pattern, positions);
+    }
+    else if (algorithmName == "Case-Insensitive") {
+        outputFile << "Algorithm: Case-Insensitive (ASCII letters)" << endl;
+        byteSearchInto(text, pattern, true, positions);
+    }
+    else if (algorithmName == "UTF-8-Case-Insensitive") {
+        outputFile << "Algorithm: UTF-8-Case-Insensitive (positions in codepoints)" << endl;
+        utf8SearchInto(text, pattern, true, positions);
+    }
+    else {
+        cout << "Invalid algorithm name." << endl;
+        return;
+    }
+
+    auto end = high_resolution_clock::now();
+    double duration = duration_cast<microseconds>(end - start).count() / 1e6;
+
+    TRACE_SCOPE("emit");
+    if (positions.empty()) {
+        outputFile << "No match found." << endl;
+    }
+    else {
+        outputFile << "Pattern found at positions: ";
+        writePositions(outputFile, positions);
+    }
+
+    outputFile << "Execution time: " << duration << " seconds" << endl;
+    cout << "Results for " << algorithmName << " written to " << outputFileName << endl;
+}
+
+// Multi-file mode: searches every file under the given paths on a work-stealing pool
+void writeMultiFileResults(const string& algorithmName, const string& pattern, const vector<string>& paths) {
+    TRACE_SCOPE("MultiFile " + algorithmName);
+    string outputFileName = "output_MultiFile_" + algorithmName + ".txt";
+    ofstream outputFile(outputFileName);
+
+    if (!outputFile) {
+        cout << "Error: Cannot open " << outputFileName << endl;
+        return;
+    }
+
+    vector<string> files = collectFiles(paths);
+    TWorkStealingPool pool;
+    vector<TFileMatches> results;
     auto start = high_resolution_clock::now();
 
     if (algorithmName == "Rabin-Karp") {
         outputFile << "Algorithm: Rabin-Karp" << endl;
-        positions = rabinKarp(text, pattern);
+        results = searchFiles(files, pattern, rabinKarp, pool);
     }
     else if (algorithmName == "Knuth-Morris-Pratt") {
         outputFile << "Algorithm: Knuth-Morris-Pratt" << endl;
-        positions = knuthMorrisPratt(text, pattern);
+        results = searchFiles(files, pattern, knuthMorrisPratt, pool);
     }
     else {
         cout << "Invalid algorithm name." << endl;
@@ -123,12 +230,75 @@ void writeResults(const string& algorithmName, const string& text, const string&
     auto end = high_resolution_clock::now();
     double duration = duration_cast<microseconds>(end - start).count() / 1e6;
 
+    TRACE_SCOPE("emit");
+    size_t total = 0;
+    for (const TFileMatches& file : results) {
+        if (!file.error.empty()) {
+            outputFile << file.path << ": Error: " << file.error << endl;
+            continue;
+        }
+        if (file.positions.empty()) {
+            continue;
+        }
+        outputFile << file.path << ": ";
+        for (size_t pos : file.positions) {
+            outputFile << pos << " ";
+        }
+        outputFile << endl;
+        total += file.positions.size();
+    }
+
+    outputFile << "Files searched: " << files.size() << ", matches: " << total << endl;
+    outputFile << "Execution time: " << duration << " seconds" << endl;
+    cout << "Results for " << algorithmName << " written to " << outputFileName << endl;
+}
+
+#ifndef _WIN32
+// Returns false if the search could not run
+bool writeShardedResults(const string& algorithmName, const string& pattern, const string& path, size_t shards) {
+    TRACE_SCOPE("Sharded " + algorithmName);
+    string outputFileName = "output_Sharded_" + algorithmName + ".txt";
+    ofstream outputFile(outputFileName);
+
+    if (!outputFile) {
+        cout << "Error: Cannot open " << outputFileName << endl;
+        return false;
+    }
+
+    TShardEngine engine;
+    if (algorithmName == "Knuth-Morris-Pratt") {
+        engine = TShardEngine::KnuthMorrisPratt;
+    }
+    else if (algorithmName == "Filter") {
+        engine = TShardEngine::Filter;
+    }
+    else {
+        cout << "Invalid algorithm name." << endl;
+        return false;
+    }
+    outputFile << "Algorithm: " << algorithmName << ", worker processes: " << shards << endl;
+
+    vector<size_t> positions;
+    auto start = high_resolution_clock::now();
+    try {
+        TShardedSearch sharded(path, shards, pattern.size());
+        positions = sharded.search(pattern, engine);
+    }
+    catch (const exception& e) {
+        outputFile << "Error: " << e.what() << endl;
+        cout << "Error: " << e.what() << endl;
+        return false;
+    }
+    auto end = high_resolution_clock::now();
+    double duration = duration_cast<microseconds>(end - start).count() / 1e6;
+
+    TRACE_SCOPE("emit");
     if (positions.empty()) {
         outputFile << "No match found." << endl;
     }
     else {
         outputFile << "Pattern found at positions: ";
-        for (int pos : positions) {
+        for (size_t pos : positions) {
             outputFile << pos << " ";
         }
         outputFile << endl;
@@ -136,22 +306,85 @@ void writeResults(const string& algorithmName, const string& text, const string&
 
     outputFile << "Execution time: " << duration << " seconds" << endl;
     cout << "Results for " << algorithmName << " written to " << outputFileName << endl;
+    return true;
+}
+
+// Number of worker processes from the command line; 0 if it is not an
+// integer from 1 to SHARDED_MAX_WORKERS
+size_t parseShards(const string& arg) {
+    if (arg.empty() || arg.find_first_not_of("0123456789") != string::npos)
+        return 0;
+    try {
+        size_t shards = stoul(arg);
+        return shards <= SHARDED_MAX_WORKERS ? shards : 0;
+    }
+    catch (const exception&) {
+        return 0;
+    }
 }
+#endif
 
-int main() {
-    ifstream inputFile("C:\\Users\\Max\\Desktop\\aicd\\input.txt");
+int main(int argc, char* argv[]) {
+    // algorithms --shards <worker processes> <pattern> <file>
+    if (argc >= 2 && string(argv[1]) == "--shards") {
+#ifdef _WIN32
+        cout << "Error: --shards needs fork and Unix-domain sockets" << endl;
+        return 1;
+#else
+        if (argc != 5) {
+            cout << "Usage: algorithms --shards <worker processes> <pattern> <file>" << endl;
+            return 1;
+        }
+        size_t shards = parseShards(argv[2]);
+        if (shards == 0) {
+            cout << "Error: the number of worker processes must be an integer from 1 to " << SHARDED_MAX_WORKERS
+                 << ", got " << argv[2] << endl;
+            return 1;
+        }
+        bool ok = writeShardedResults("Knuth-Morris-Pratt", argv[3], argv[4], shards);
+        ok = writeShardedResults("Filter", argv[3], argv[4], shards) && ok;
+        return ok ? 0 : 1;
+#endif
+    }
 
-    if (!inputFile) {
-        cout << "Error: Cannot open input.txt" << endl;
+    // algorithms [--occurrence-set]: searches input.txt, storing matches in a TOccurrenceSet
+    bool occurrenceSet = argc == 2 && string(argv[1]) == "--occurrence-set";
+    if (argc == 2 && !occurrenceSet) {
+        cout << "Unknown option " << argv[1] << endl;
         return 1;
     }
 
+    // algorithms <pattern> <file or directory>...
+    if (argc >= 3) {
+        string pattern = argv[1];
+        vector<string> paths(argv + 2, argv + argc);
+
+        writeMultiFileResults("Rabin-Karp", pattern, paths);
+        writeMultiFileResults("Knuth-Morris-Pratt", pattern, paths);
+        return 0;
+    }
+
     string text, pattern;
-    getline(inputFile, text);
-    getline(inputFile, pattern);
+    {
+        TRACE_SCOPE("load");
+        ifstream inputFile("C:\\Users\\Max\\Desktop\\aicd\\input.txt");
+
+        if (!inputFile) {
+            cout << "Error: Cannot open input.txt" << endl;
+            return 1;
+        }
+
+        getline(inputFile, text);
+        getline(inputFile, pattern);
+    }
 
-    writeResults("Rabin-Karp", text, pattern);
-    writeResults("Knuth-Morris-Pratt", text, pattern);
+    auto write = occurrenceSet ? writeResults<TOccurrenceSet> : writeResults<vector<int>>;
+    write("Rabin-Karp", text, pattern);
+    write("Knuth-Morris-Pratt", text, pattern);
+    write("Rabin-Karp-SIMD", text, pattern);
+    write("Wildcard-NTT", text, pattern);
+    write("Case-Insensitive", text, pattern);
+    write("UTF-8-Case-Insensitive", text, pattern);
 
     return 0;
 }
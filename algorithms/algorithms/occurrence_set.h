@@ -0,0 +1,232 @@
+#ifndef INCLUDE_OCCURRENCE_SET_H_
+#define INCLUDE_OCCURRENCE_SET_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+inline unsigned popcount64(uint64_t x) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<unsigned>(__popcnt64(x));
+#elif defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcountll(x));
+#else
+    unsigned count = 0;
+    for (; x; x &= x - 1)
+        ++count;
+    return count;
+#endif
+}
+
+// Sorted set of match positions, Roaring style: positions are grouped by
+// their upper bits into containers of 65536 positions each. A sparse container
+// is a sorted array of 16-bit offsets (2 bytes per match); once it holds more
+// than ARRAY_LIMIT matches it becomes a 8 KB bitmap with a popcount prefix per
+// 64-bit word. Compared to an int per text byte this takes at most 1.25 bits
+// per text byte, and far less when matches are sparse.
+//
+// rank() is O(1) for bitmap containers and O(log 4096) for array ones.
+// select() is sampled: the container and word of every SELECT_SAMPLE-th match
+// are kept (8 bytes per 256 matches), so select() only looks at what lies
+// between two samples - constant time for a fixed sampling rate.
+class TOccurrenceSet {
+public:
+    static constexpr size_t CHUNK_BITS = 16;
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static constexpr size_t WORDS = CHUNK_SIZE / 64;
+    static constexpr size_t ARRAY_LIMIT = 4096;
+    static constexpr size_t SELECT_SAMPLE = 256;
+
+    TOccurrenceSet() : _size(0) {}
+
+    // Adds a position; positions must arrive in increasing order, as every searcher emits them
+    void push_back(size_t pos) {
+        size_t key = pos >> CHUNK_BITS;
+        if (_containers.empty() || _containers.back().key != key) {
+            if (!_containers.empty() && _containers.back().key > key)
+                throw std::invalid_argument("Positions must be added in increasing order");
+            _containers.push_back(TContainer(key, _size));
+            while (_firstAtOrAfter.size() <= key)
+                _firstAtOrAfter.push_back(static_cast<uint32_t>(_containers.size() - 1));
+        }
+
+        TContainer& c = _containers.back();
+        uint16_t low = static_cast<uint16_t>(pos & (CHUNK_SIZE - 1));
+        if (c.bitmap.empty()) {
+            if (!c.array.empty() && c.array.back() >= low) {
+                if (c.array.back() == low)
+                    return;
+                throw std::invalid_argument("Positions must be added in increasing order");
+            }
+            c.array.push_back(low);
+            if (c.array.size() > ARRAY_LIMIT)
+                toBitmap(c);
+        }
+        else {
+            if (c.count > 0 && c.last >= low) {
+                if (c.last == low)
+                    return;
+                throw std::invalid_argument("Positions must be added in increasing order");
+            }
+            setBit(c, low);
+        }
+        if (_size % SELECT_SAMPLE == 0)
+            _selectSamples.push_back({ static_cast<uint32_t>(_containers.size() - 1), static_cast<uint16_t>(low / 64) });
+        c.last = low;
+        ++c.count;
+        ++_size;
+    }
+
+    size_t size() const noexcept {
+        return _size;
+    }
+
+    bool empty() const noexcept {
+        return _size == 0;
+    }
+
+    bool contains(size_t pos) const {
+        return rank(pos + 1) - rank(pos) == 1;
+    }
+
+    // Number of matches at positions < pos
+    size_t rank(size_t pos) const {
+        size_t key = pos >> CHUNK_BITS;
+        if (key >= _firstAtOrAfter.size())
+            return _size;
+        const TContainer& c = _containers[_firstAtOrAfter[key]];
+        if (c.key != key)
+            return c.before;
+
+        uint16_t low = static_cast<uint16_t>(pos & (CHUNK_SIZE - 1));
+        if (c.bitmap.empty())
+            return c.before + (std::lower_bound(c.array.begin(), c.array.end(), low) - c.array.begin());
+
+        size_t word = low / 64;
+        if (word > c.last / 64u)
+            return c.before + c.count;
+        uint64_t mask = (uint64_t(1) << (low % 64)) - 1;
+        return c.before + c.wordRank[word] + popcount64(c.bitmap[word] & mask);
+    }
+
+    // Position of the k-th match (counting from 0)
+    size_t select(size_t k) const {
+        if (k >= _size)
+            throw std::out_of_range("Index out of range");
+        size_t sample = k / SELECT_SAMPLE;
+        size_t index = _selectSamples[sample].container;
+        // Every container holds at least one match, so this passes at most SELECT_SAMPLE of them
+        while (index + 1 < _containers.size() && _containers[index + 1].before <= k)
+            ++index;
+        const TContainer& c = _containers[index];
+        size_t inner = k - c.before;
+        size_t base = c.key << CHUNK_BITS;
+        if (c.bitmap.empty())
+            return base + c.array[inner];
+
+        // The k-th match lies between the words of this sample and the next one
+        size_t first = index == _selectSamples[sample].container ? _selectSamples[sample].word : 0;
+        size_t last = c.last / 64u;
+        if (sample + 1 < _selectSamples.size() && _selectSamples[sample + 1].container == index)
+            last = _selectSamples[sample + 1].word;
+        size_t word = std::upper_bound(c.wordRank.begin() + first, c.wordRank.begin() + last + 1, inner) - c.wordRank.begin() - 1;
+        return base + word * 64 + selectInWord(c.bitmap[word], inner - c.wordRank[word]);
+    }
+
+    // Calls f(pos) for every match in increasing order
+    template<typename Func>
+    void forEach(Func f) const {
+        for (const TContainer& c : _containers) {
+            size_t base = c.key << CHUNK_BITS;
+            if (c.bitmap.empty()) {
+                for (uint16_t low : c.array)
+                    f(base + low);
+                continue;
+            }
+            for (size_t word = 0; word < WORDS; ++word) {
+                for (uint64_t bits = c.bitmap[word]; bits; bits &= bits - 1)
+                    f(base + word * 64 + lowestBit(bits));
+            }
+        }
+    }
+
+    // Bytes held by the set
+    size_t memoryUsage() const noexcept {
+        size_t bytes = sizeof(*this) + _containers.capacity() * sizeof(TContainer)
+            + _firstAtOrAfter.capacity() * sizeof(uint32_t) + _selectSamples.capacity() * sizeof(TSelectSample);
+        for (const TContainer& c : _containers) {
+            bytes += c.array.capacity() * sizeof(uint16_t) + c.bitmap.capacity() * sizeof(uint64_t)
+                + c.wordRank.capacity() * sizeof(uint16_t);
+        }
+        return bytes;
+    }
+
+private:
+    struct TContainer {
+        size_t key;
+        size_t before;  // matches in all earlier containers
+        uint32_t count;
+        uint16_t last;  // largest offset stored so far
+        std::vector<uint16_t> array;
+        std::vector<uint64_t> bitmap;
+        std::vector<uint16_t> wordRank;  // matches before each bitmap word
+
+        TContainer(size_t key, size_t before) : key(key), before(before), count(0), last(0) {}
+    };
+
+    struct TSelectSample {
+        uint32_t container;
+        uint16_t word;  // bitmap word of the sampled match
+    };
+
+    std::vector<TContainer> _containers;
+    std::vector<uint32_t> _firstAtOrAfter;  // key -> first container with key >= it
+    std::vector<TSelectSample> _selectSamples;  // match SELECT_SAMPLE * i for every i
+    size_t _size;
+
+    static unsigned lowestBit(uint64_t bits) {
+        return popcount64((bits & (0 - bits)) - 1);
+    }
+
+    // Offset of the set bit with the given rank: skips whole bytes, then at most 7 bits
+    static unsigned selectInWord(uint64_t bits, size_t rank) {
+        unsigned offset = 0;
+        for (unsigned count; rank >= (count = popcount64(bits & 0xFF)); bits >>= 8, offset += 8)
+            rank -= count;
+        for (; rank > 0; --rank)
+            bits &= bits - 1;
+        return offset + lowestBit(bits);
+    }
+
+    // Bits are only ever set at or after the last word, so the word prefixes
+    // can be filled in as the bitmap grows
+    static void setBit(TContainer& c, uint16_t low) {
+        size_t word = low / 64;
+        size_t lastWord = c.count == 0 ? 0 : c.last / 64u;
+        for (size_t w = lastWord + 1; w <= word; ++w)
+            c.wordRank[w] = static_cast<uint16_t>(c.count);
+        c.bitmap[word] |= uint64_t(1) << (low % 64);
+    }
+
+    static void toBitmap(TContainer& c) {
+        c.bitmap.assign(WORDS, 0);
+        c.wordRank.assign(WORDS, 0);
+        uint32_t count = 0;
+        for (uint16_t low : c.array) {
+            c.count = count;
+            setBit(c, low);
+            c.last = low;
+            ++count;
+        }
+        c.count = count - 1;  // push_back counts the newest position itself
+        std::vector<uint16_t>().swap(c.array);
+    }
+};
+
+#endif  // INCLUDE_OCCURRENCE_SET_H_
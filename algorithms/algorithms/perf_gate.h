@@ -0,0 +1,232 @@
+#ifndef INCLUDE_PERF_GATE_H_
+#define INCLUDE_PERF_GATE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Timing samples of one (case, algorithm) pair, in seconds
+using TPerfKey = std::pair<std::string, std::string>;
+using TPerfSamples = std::map<TPerfKey, std::vector<double>>;
+
+// Samples in text form, as exp --perf-sample prints them: one line per pair,
+// "case<TAB>algorithm<TAB>s1 s2 ..."; lines starting with '#' are comments,
+// except "# build: <description>", which names the build that took the samples
+inline bool readPerfSamples(std::istream& in, TPerfSamples& samples, std::string* build = nullptr) {
+    const std::string buildPrefix = "# build: ";
+    std::string line;
+    while (std::getline(in, line)) {
+        if (build && line.compare(0, buildPrefix.size(), buildPrefix) == 0) {
+            *build = line.substr(buildPrefix.size());
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        size_t first = line.find('\t');
+        size_t second = first == std::string::npos ? first : line.find('\t', first + 1);
+        if (second == std::string::npos) {
+            return false;
+        }
+        std::vector<double>& values = samples[{ line.substr(0, first), line.substr(first + 1, second - first - 1) }];
+        std::istringstream numbers(line.substr(second + 1));
+        for (double value; numbers >> value;) {
+            values.push_back(value);
+        }
+    }
+    return true;
+}
+
+inline void writePerfSamples(std::ostream& out, const TPerfSamples& samples, const std::string& build) {
+    out << "# build: " << build << "\n";
+    out << "# case\talgorithm\tseconds per run\n";
+    std::streamsize precision = out.precision(9);
+    for (const auto& entry : samples) {
+        out << entry.first.first << "\t" << entry.first.second << "\t";
+        for (size_t i = 0; i < entry.second.size(); ++i) {
+            out << (i ? " " : "") << entry.second[i];
+        }
+        out << "\n";
+    }
+    out.precision(precision);
+}
+
+// Runs a command that prints samples and appends them to `samples`; false if
+// it could not be started, failed or printed something else
+inline bool runPerfCommand(const std::string& command, TPerfSamples& samples, std::string* build = nullptr) {
+#ifdef _WIN32
+    FILE* pipe = _popen(command.c_str(), "r");
+#else
+    FILE* pipe = popen(command.c_str(), "r");
+#endif
+    if (!pipe) {
+        return false;
+    }
+    std::string output;
+    char buffer[4096];
+    for (size_t read; (read = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0;) {
+        output.append(buffer, read);
+    }
+#ifdef _WIN32
+    int status = _pclose(pipe);
+#else
+    int status = pclose(pipe);
+#endif
+    std::istringstream in(output);
+    return status == 0 && readPerfSamples(in, samples, build);
+}
+
+inline double medianOf(std::vector<double> values) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t half = values.size() / 2;
+    return values.size() % 2 ? values[half] : (values[half - 1] + values[half]) / 2;
+}
+
+// Interquartile range relative to the median: how far separate runs of one
+// binary spread on this machine
+inline double relativeSpread(std::vector<double> values) {
+    if (values.size() < 2) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    auto quantile = [&](double q) {
+        double index = q * (values.size() - 1);
+        size_t below = static_cast<size_t>(index);
+        size_t above = std::min(below + 1, values.size() - 1);
+        return values[below] + (values[above] - values[below]) * (index - below);
+    };
+    double median = quantile(0.5);
+    return median > 0 ? (quantile(0.75) - quantile(0.25)) / median : 0;
+}
+
+// One-sided Mann-Whitney U test: p-value of the hypothesis that `current`
+// tends to be larger (slower) than `baseline`. Ties get average ranks; the
+// normal approximation with tie and continuity correction is accurate enough
+// from about 8 samples per side.
+inline double mannWhitneyGreater(const std::vector<double>& current, const std::vector<double>& baseline) {
+    size_t n1 = current.size();
+    size_t n2 = baseline.size();
+    if (n1 == 0 || n2 == 0) {
+        return 1;
+    }
+
+    std::vector<std::pair<double, int>> all;
+    for (double value : current)
+        all.push_back({ value, 1 });
+    for (double value : baseline)
+        all.push_back({ value, 0 });
+    std::sort(all.begin(), all.end());
+
+    double N = static_cast<double>(n1 + n2);
+    double rankSum = 0;
+    double ties = 0;
+    for (size_t i = 0; i < all.size();) {
+        size_t j = i;
+        while (j < all.size() && all[j].first == all[i].first)
+            ++j;
+        double rank = (i + 1 + j) / 2.0;  // average of ranks i + 1 .. j
+        for (size_t k = i; k < j; ++k) {
+            if (all[k].second)
+                rankSum += rank;
+        }
+        double t = static_cast<double>(j - i);
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    double u = rankSum - n1 * (n1 + 1) / 2.0;
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((N + 1) - ties / (N * (N - 1)));
+    if (variance <= 0) {
+        return 1;
+    }
+    double z = (u - mean - 0.5) / std::sqrt(variance);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+struct TPerfComparison {
+    TPerfKey key;
+    double baselineMedian;
+    double currentMedian;
+    double pValue;
+    double adjustedPValue;  // Holm-adjusted over all pairs of the comparison
+    double tolerance;       // slowdown that still counts as noise
+    bool inBaseline;
+    bool slower;  // significant and larger than the tolerance
+};
+
+// A pair counts as slower when the U test rejects "not slower" at level alpha
+// and the median grew by more than its tolerance, so that statistically clear
+// but negligible shifts do not fail the gate. The tolerance is the larger
+// relative spread of the two sides' samples, and at least minTolerance (5%).
+// The test assumes independent samples: take them from separate process runs
+// of the two binaries, interleaved in time, so that a slow phase of the
+// machine hits both sides alike instead of looking like a regression.
+// Every pair is a separate test, so the p-values get the Holm correction:
+// the chance that any pair of an unchanged build fails stays below alpha.
+inline std::vector<TPerfComparison> comparePerf(const TPerfSamples& baseline, const TPerfSamples& current,
+                                                double alpha = 0.01, double minTolerance = 0.05) {
+    std::vector<TPerfComparison> result;
+    std::vector<size_t> tested;
+    for (const auto& entry : current) {
+        TPerfComparison c;
+        c.key = entry.first;
+        c.currentMedian = medianOf(entry.second);
+        auto it = baseline.find(entry.first);
+        c.inBaseline = it != baseline.end() && !it->second.empty();
+        c.baselineMedian = c.inBaseline ? medianOf(it->second) : 0;
+        c.pValue = c.inBaseline ? mannWhitneyGreater(entry.second, it->second) : 1;
+        c.adjustedPValue = 1;
+        c.tolerance = minTolerance;
+        if (c.inBaseline)
+            c.tolerance = std::max({ minTolerance, relativeSpread(entry.second), relativeSpread(it->second) });
+        c.slower = false;
+        if (c.inBaseline)
+            tested.push_back(result.size());
+        result.push_back(c);
+    }
+
+    // Holm: the i-th smallest of the M p-values is scaled by M - i, and the
+    // adjusted values are made monotone so that the order is kept
+    std::sort(tested.begin(), tested.end(), [&](size_t a, size_t b) { return result[a].pValue < result[b].pValue; });
+    double running = 0;
+    for (size_t i = 0; i < tested.size(); ++i) {
+        TPerfComparison& c = result[tested[i]];
+        running = std::max(running, std::min(1.0, c.pValue * (tested.size() - i)));
+        c.adjustedPValue = running;
+        c.slower = c.adjustedPValue < alpha && c.currentMedian > c.baselineMedian * (1 + c.tolerance);
+    }
+    return result;
+}
+
+inline void printPerfTable(std::ostream& out, const std::vector<TPerfComparison>& comparisons) {
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-14s %-12s %12s %12s %9s %8s %9s %10s  %s\n",
+                  "case", "algorithm", "baseline, s", "current, s", "change", "speedup", "tolerance", "Holm p", "verdict");
+    out << line;
+    for (const TPerfComparison& c : comparisons) {
+        if (!c.inBaseline) {
+            std::snprintf(line, sizeof(line), "%-14s %-12s %12s %12.6f %9s %8s %9s %10s  %s\n",
+                          c.key.first.c_str(), c.key.second.c_str(), "-", c.currentMedian, "-", "-", "-", "-", "new");
+        }
+        else {
+            double change = c.baselineMedian > 0 ? (c.currentMedian / c.baselineMedian - 1) * 100 : 0;
+            double speedup = c.currentMedian > 0 ? c.baselineMedian / c.currentMedian : 0;
+            std::snprintf(line, sizeof(line), "%-14s %-12s %12.6f %12.6f %+8.1f%% %7.2fx %8.1f%% %10.2g  %s\n",
+                          c.key.first.c_str(), c.key.second.c_str(), c.baselineMedian, c.currentMedian, change,
+                          speedup, c.tolerance * 100, c.adjustedPValue, c.slower ? "SLOWER" : "ok");
+        }
+        out << line;
+    }
+}
+
+#endif  // INCLUDE_PERF_GATE_H_
@@ -0,0 +1,216 @@
+#ifndef INCLUDE_RABIN_KARP_SIMD_H_
+#define INCLUDE_RABIN_KARP_SIMD_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "trace.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define RABIN_KARP_AVX2_TARGET __attribute__((target("avx2")))
+#define RABIN_KARP_HAS_AVX2_KERNEL
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#include <intrin.h>
+#define RABIN_KARP_AVX2_TARGET
+#define RABIN_KARP_HAS_AVX2_KERNEL
+#endif
+
+// Rabin-Karp with the rolling-hash dependency chain split into 8 lanes.
+// The windows are cut into 8 contiguous segments and every lane rolls its own
+// hash through one segment, so 8 independent multiply chains run side by side
+// (in one AVX2 register when the CPU has it). Hashes are polynomials modulo
+// 2^32 over unsigned bytes, and every hash hit is verified with memcmp, so the
+// matches are exactly those of rabinKarp().
+class TRabinKarpLanes {
+public:
+    static constexpr size_t LANES = 8;
+    static constexpr uint32_t BASE = 257;
+
+    // useAvx2 = false forces the portable lane loop (for comparisons)
+    TRabinKarpLanes(std::string_view text, std::string_view pattern, bool useAvx2 = true)
+        : _text(reinterpret_cast<const unsigned char*>(text.data())),
+          _pattern(reinterpret_cast<const unsigned char*>(pattern.data())),
+          _n(text.size()), _m(pattern.size()), _windows(0), _segment(0), _power(1), _patternHash(0), _useAvx2(useAvx2) {
+        if (_m == 0 || _m > _n)
+            return;
+        TRACE_SCOPE("preprocess");
+        _windows = _n - _m + 1;
+        _segment = (_windows + LANES - 1) / LANES;
+        for (size_t i = 0; i + 1 < _m; ++i)
+            _power *= BASE;
+        _patternHash = hash(_pattern);
+    }
+
+    std::vector<int> run() {
+        std::vector<int> positions;
+        runInto(positions);
+        return positions;
+    }
+
+    // Appends the matches to positions (a vector<int> or a TOccurrenceSet) in
+    // increasing order; lanes collect their own segments and are merged at the end
+    template<typename Positions>
+    void runInto(Positions& positions) {
+        if (_windows == 0)
+            return;
+
+        uint32_t h[LANES] = { 0 };
+        {
+            TRACE_SCOPE("preprocess");
+            for (size_t k = 0; k < LANES; ++k) {
+                if (k * _segment < _windows)
+                    h[k] = hash(_text + k * _segment);
+            }
+        }
+
+        TRACE_SCOPE("scan");
+
+        size_t done = 0;
+        if (_windows >= 64 * LANES) {
+#ifdef RABIN_KARP_HAS_AVX2_KERNEL
+            if (_useAvx2 && cpuHasAvx2())
+                done = runAvx2(h);
+            else
+#endif
+                done = runInterleaved(h);
+        }
+        for (size_t k = 0; k < LANES; ++k)
+            finishLane(k, done, h[k]);
+
+        for (size_t k = 0; k < LANES; ++k) {
+            for (int pos : _found[k])
+                positions.push_back(pos);
+        }
+    }
+
+private:
+    const unsigned char* _text;
+    const unsigned char* _pattern;
+    size_t _n;
+    size_t _m;
+    size_t _windows;
+    size_t _segment;   // windows per lane (the last lane may get fewer)
+    uint32_t _power;   // BASE^(m-1)
+    uint32_t _patternHash;
+    bool _useAvx2;
+    std::vector<int> _found[LANES];
+
+    uint32_t hash(const unsigned char* s) const {
+        uint32_t h = 0;
+        for (size_t j = 0; j < _m; ++j)
+            h = h * BASE + s[j];
+        return h;
+    }
+
+    size_t laneEnd(size_t k) const {
+        size_t end = (k + 1) * _segment;
+        return end < _windows ? end : _windows;
+    }
+
+    void check(size_t i) {
+        if (std::memcmp(_text + i, _pattern, _m) == 0)
+            _found[i / _segment].push_back(static_cast<int>(i));
+    }
+
+    // Scalar continuation of lane k from step `from` of its segment
+    void finishLane(size_t k, size_t from, uint32_t h) {
+        size_t begin = k * _segment;
+        size_t end = laneEnd(k);
+        for (size_t i = begin + from; i < end; ++i) {
+            if (h == _patternHash)
+                check(i);
+            if (i + 1 < end)
+                h = (h - _text[i] * _power) * BASE + _text[i + _m];
+        }
+    }
+
+    // Portable kernel: the 8 chains are advanced together, one step each per
+    // iteration, while every lane still has windows left. It stops one step
+    // before the end of the last lane: rolling past the last window would read
+    // _text[_n], so finishLane checks that window without rolling
+    size_t runInterleaved(uint32_t* h) {
+        size_t steps = laneEnd(LANES - 1) - (LANES - 1) * _segment - 1;
+        for (size_t s = 0; s < steps; ++s) {
+            for (size_t k = 0; k < LANES; ++k) {
+                if (h[k] == _patternHash)
+                    check(k * _segment + s);
+            }
+            for (size_t k = 0; k < LANES; ++k) {
+                size_t i = k * _segment + s;
+                h[k] = (h[k] - _text[i] * _power) * BASE + _text[i + _m];
+            }
+        }
+        return steps;
+    }
+
+#ifdef RABIN_KARP_HAS_AVX2_KERNEL
+    static bool cpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    // Runs all lanes in one register while every lane still has windows left and
+    // the 4-byte gathers stay inside the text; returns the number of steps done
+    RABIN_KARP_AVX2_TARGET size_t runAvx2(uint32_t* h) {
+        size_t lastLane = (LANES - 1) * _segment;
+        size_t steps = laneEnd(LANES - 1) - lastLane;
+        if (lastLane + steps + _m + 3 >= _n)
+            steps = _n - 3 - _m - lastLane;
+
+        __m256i offsets = _mm256_setr_epi32(0, int(_segment), int(2 * _segment), int(3 * _segment),
+                                            int(4 * _segment), int(5 * _segment), int(6 * _segment), int(7 * _segment));
+        __m256i hashes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h));
+        const __m256i target = _mm256_set1_epi32(int(_patternHash));
+        const __m256i power = _mm256_set1_epi32(int(_power));
+        const __m256i base = _mm256_set1_epi32(int(BASE));
+        const __m256i byteMask = _mm256_set1_epi32(0xFF);
+
+        for (size_t s = 0; s < steps; ++s) {
+            int hits = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(hashes, target)));
+            while (hits) {
+                size_t k = 0;
+                while (!(hits & (1 << k)))
+                    ++k;
+                hits &= hits - 1;
+                check(k * _segment + s);
+            }
+            __m256i out = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(_text + s), offsets, 1), byteMask);
+            __m256i in = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(_text + s + _m), offsets, 1), byteMask);
+            hashes = _mm256_sub_epi32(hashes, _mm256_mullo_epi32(out, power));
+            hashes = _mm256_add_epi32(_mm256_mullo_epi32(hashes, base), in);
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(h), hashes);
+        return steps;
+    }
+#endif
+};
+
+inline std::vector<int> rabinKarpSimd(std::string_view text, std::string_view pattern) {
+    return TRabinKarpLanes(text, pattern).run();
+}
+
+template<typename Positions>
+void rabinKarpSimdInto(std::string_view text, std::string_view pattern, Positions& positions) {
+    TRabinKarpLanes(text, pattern).runInto(positions);
+}
+
+#endif  // INCLUDE_RABIN_KARP_SIMD_H_
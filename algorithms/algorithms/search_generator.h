@@ -0,0 +1,200 @@
+#ifndef INCLUDE_SEARCH_GENERATOR_H_
+#define INCLUDE_SEARCH_GENERATOR_H_
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "case_fold.h"
+#include "failure_table.h"
+#include "rabin_karp_simd.h"
+#include "wildcard_search.h"
+
+// Lazily produced sequence of values backed by a C++20 coroutine.
+// The coroutine frame is allocated once when the generator is created;
+// every co_yield only stores the value and suspends, so producing a value
+// allocates nothing.
+template<typename T>
+class TGenerator {
+public:
+    struct promise_type {
+        T current{};
+        std::exception_ptr error;
+
+        TGenerator get_return_object() {
+            return TGenerator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(T value) noexcept {
+            current = value;
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    struct sentinel {};
+
+    class iterator {
+    public:
+        explicit iterator(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+        const T& operator*() const { return _handle.promise().current; }
+
+        iterator& operator++() {
+            resume(_handle);
+            return *this;
+        }
+
+        bool operator==(sentinel) const { return _handle.done(); }
+        bool operator!=(sentinel s) const { return !(*this == s); }
+
+    private:
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    TGenerator(TGenerator&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+
+    TGenerator& operator=(TGenerator other) noexcept {
+        std::swap(_handle, other._handle);
+        return *this;
+    }
+
+    ~TGenerator() {
+        if (_handle)
+            _handle.destroy();
+    }
+
+    // Runs the coroutine up to its first value
+    iterator begin() {
+        resume(_handle);
+        return iterator(_handle);
+    }
+
+    sentinel end() const noexcept {
+        return {};
+    }
+
+private:
+    std::coroutine_handle<promise_type> _handle;
+
+    explicit TGenerator(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+    static void resume(std::coroutine_handle<promise_type> handle) {
+        handle.resume();
+        if (handle.promise().error)
+            std::rethrow_exception(handle.promise().error);
+    }
+};
+
+enum class TSearchEngine {
+    KnuthMorrisPratt,  // compactKmpAdvance, its state carried from block to block
+    RabinKarp,         // lane-parallel rolling hash of rabinKarpSimd
+    Filter,            // SIMD first/middle/last byte filter of byteScan
+    IgnoreCase,        // the filter with ASCII case folding
+    Wildcard           // NTT matching of wildcardSearch, '?' matches any character
+};
+
+// Text scanned by the batch engine per resumption of a lazy search
+const size_t LAZY_BLOCK_SIZE = 64 << 10;
+
+// Lazy form of a batch engine. The text is cut into blocks of blockSize
+// windows (at least 16 pattern lengths, so the m - 1 bytes every block
+// reads past its end stay cheap); scan(block, found) runs the engine over
+// one block and the matches are yielded one at a time before the next block
+// is scanned. Leaving the loop early skips the remaining blocks. The match
+// buffer is reused from block to block, so producing a value allocates nothing.
+//
+// A coroutine cannot suspend inside the engines' callbacks, so matches are
+// produced a block ahead instead of exactly at the scan position; this way
+// every engine keeps its own scan loop.
+template<typename Scan>
+TGenerator<size_t> blockMatches(std::string_view text, std::string_view pattern, Scan scan,
+                                size_t blockSize = LAZY_BLOCK_SIZE) {
+    size_t n = text.size();
+    size_t m = pattern.size();
+    if (m == 0 || m > n) {
+        co_return;
+    }
+    blockSize = std::max(blockSize, 16 * m);
+
+    std::vector<size_t> found;
+    for (size_t begin = 0; begin + m <= n; begin += blockSize) {
+        size_t end = std::min(begin + blockSize + m - 1, n);
+        found.clear();
+        scan(text.substr(begin, end - begin), found);
+        for (size_t pos : found) {
+            co_yield begin + pos;
+        }
+    }
+}
+
+// Lazy KMP. The automaton state carries over from block to block, so blocks
+// need no overlap and stay blockSize bytes long for any pattern length: a long
+// pattern does not turn the first block into a scan of the whole text.
+inline TGenerator<size_t> kmpMatches(std::string_view text, std::string_view pattern,
+                                     size_t blockSize = LAZY_BLOCK_SIZE) {
+    size_t n = text.size();
+    size_t m = pattern.size();
+    if (m == 0 || m > n) {
+        co_return;
+    }
+    TCompactFailureTable<uint32_t> table(pattern);
+
+    std::vector<size_t> found;
+    size_t j = 0;
+    for (size_t begin = 0; begin < n; begin += blockSize) {
+        found.clear();
+        j = compactKmpAdvance(text.substr(begin, blockSize), pattern, table, j, begin,
+                              [&found](size_t start) { found.push_back(start); });
+        for (size_t pos : found) {
+            co_yield pos;
+        }
+    }
+}
+
+// for (size_t pos : lazySearch(text, pattern)) { ... } - matches in increasing order,
+// produced one at a time; leaving the loop early stops the scan.
+// The generator keeps views of text and pattern: both must outlive the loop, so
+// pass named strings or literals, not temporaries such as lazySearch(a + b, p).
+inline TGenerator<size_t> lazySearch(std::string_view text, std::string_view pattern,
+                                     TSearchEngine engine = TSearchEngine::KnuthMorrisPratt) {
+    auto into = [](std::vector<size_t>& found) {
+        return [&found](size_t i) { found.push_back(i); };
+    };
+    switch (engine) {
+    case TSearchEngine::RabinKarp:
+        return blockMatches(text, pattern, [pattern](std::string_view block, std::vector<size_t>& found) {
+            rabinKarpSimdInto(block, pattern, found);
+        });
+    case TSearchEngine::Filter:
+        return blockMatches(text, pattern, [pattern, into](std::string_view block, std::vector<size_t>& found) {
+            byteScan<false>(block, pattern, into(found));
+        });
+    case TSearchEngine::IgnoreCase:
+        return blockMatches(text, pattern, [pattern, into](std::string_view block, std::vector<size_t>& found) {
+            byteScan<true>(block, pattern, into(found));
+        });
+    case TSearchEngine::Wildcard: {
+        // The transforms are built once for the whole text, and every block is a
+        // whole number of transform steps, so no block pays for a padded transform
+        TWildcardMatcher matcher(pattern, text.size());
+        size_t blockSize = LAZY_BLOCK_SIZE;
+        if (size_t step = matcher.step())
+            blockSize = (std::max(blockSize, 16 * pattern.size()) + step - 1) / step * step;
+        return blockMatches(text, pattern, [matcher = std::move(matcher)](std::string_view block, std::vector<size_t>& found) mutable {
+            matcher.runInto(block, found);
+        }, blockSize);
+    }
+    default:
+        return kmpMatches(text, pattern);
+    }
+}
+
+#endif  // INCLUDE_SEARCH_GENERATOR_H_
@@ -0,0 +1,270 @@
+#ifndef INCLUDE_SHARDED_SEARCH_H_
+#define INCLUDE_SHARDED_SEARCH_H_
+
+// Worker processes need fork, mmap and Unix-domain sockets
+#ifndef _WIN32
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "case_fold.h"
+#include "failure_table.h"
+
+// Upper bound on worker processes: every one is forked up front
+const size_t SHARDED_MAX_WORKERS = 256;
+
+enum class TShardEngine : uint32_t {
+    KnuthMorrisPratt,  // compactKmp
+    Filter             // SIMD first/middle/last byte filter of byteScan
+};
+
+// Searches one file split into shards, each owned by a worker process.
+//
+// The constructor forks `workers` processes. Worker k maps bytes
+// [k * shard, (k + 1) * shard + maxPatternLength - 1) of the file, so the
+// shards overlap by maxPatternLength - 1 bytes and a match crossing a shard
+// boundary is still seen whole by the worker it starts in. Workers only report
+// matches starting in their own shard, which keeps every match reported once.
+//
+// The coordinator talks to every worker over its own Unix-domain socket:
+//   query: uint32 engine, uint32 pattern length, pattern bytes
+//   reply: uint64 count, count * uint64 positions relative to the shard
+// A query with length 0 tells the worker to exit. search() sends the query
+// to all workers before reading any reply, so the shards are scanned in
+// parallel; then it adds the shard offsets. Shards are disjoint and ordered,
+// so appending their sorted replies in shard order gives sorted output.
+// If a query fails partway, the workers may still hold unread replies, so the
+// instance shuts them all down and every later search() throws.
+// Another transport (TCP to other machines) only has to carry the same messages.
+class TShardedSearch {
+public:
+    TShardedSearch(const std::string& path, size_t workers, size_t maxPatternLength)
+        : _fileSize(0), _shardSize(0), _maxPatternLength(maxPatternLength) {
+        if (workers == 0 || maxPatternLength == 0)
+            throw std::invalid_argument("Need at least one worker and a positive pattern length");
+        if (workers > SHARDED_MAX_WORKERS)
+            throw std::invalid_argument("At most " + std::to_string(SHARDED_MAX_WORKERS) + " workers are supported");
+
+        struct stat info;
+        if (::stat(path.c_str(), &info) != 0)
+            throw std::system_error(errno, std::generic_category(), "Cannot stat " + path);
+        _fileSize = static_cast<size_t>(info.st_size);
+        _shardSize = (_fileSize + workers - 1) / workers;
+
+        for (size_t k = 0; k < workers; ++k) {
+            int sockets[2];
+            if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+                int error = errno;
+                shutdown();
+                throw std::system_error(error, std::generic_category(), "socketpair failed");
+            }
+            pid_t pid = ::fork();
+            if (pid < 0) {
+                int error = errno;
+                ::close(sockets[0]);
+                ::close(sockets[1]);
+                shutdown();
+                throw std::system_error(error, std::generic_category(), "fork failed");
+            }
+            if (pid == 0) {
+                ::close(sockets[0]);
+                for (const TWorker& w : _workers)
+                    ::close(w.socket);
+                size_t start = std::min(k * _shardSize, _fileSize);
+                size_t own = std::min(_shardSize, _fileSize - start);
+                ::_exit(serve(sockets[1], path, start, own, std::min(own + maxPatternLength - 1, _fileSize - start)));
+            }
+            ::close(sockets[1]);
+            _workers.push_back({ pid, sockets[0], std::min(k * _shardSize, _fileSize) });
+        }
+    }
+
+    TShardedSearch(const TShardedSearch&) = delete;
+    TShardedSearch& operator=(const TShardedSearch&) = delete;
+
+    ~TShardedSearch() {
+        shutdown();
+    }
+
+    // Sorted byte offsets of all matches in the file
+    std::vector<size_t> search(std::string_view pattern, TShardEngine engine = TShardEngine::KnuthMorrisPratt) {
+        if (_workers.empty())
+            throw std::runtime_error("Workers were shut down after a failed query");
+        if (pattern.size() > _maxPatternLength)
+            throw std::invalid_argument("Pattern is longer than the shard overlap allows");
+        std::vector<size_t> positions;
+        if (pattern.empty())
+            return positions;
+
+        try {
+            query(pattern, engine, positions);
+        }
+        catch (...) {
+            shutdown();
+            throw;
+        }
+        return positions;
+    }
+
+    size_t workers() const noexcept {
+        return _workers.size();
+    }
+
+    size_t fileSize() const noexcept {
+        return _fileSize;
+    }
+
+private:
+    struct TWorker {
+        pid_t pid;
+        int socket;
+        size_t offset;  // file offset of the shard
+    };
+
+    std::vector<TWorker> _workers;
+    size_t _fileSize;
+    size_t _shardSize;
+    size_t _maxPatternLength;
+
+    // Sends the query to every worker, then appends their replies in shard order
+    void query(std::string_view pattern, TShardEngine engine, std::vector<size_t>& positions) {
+        uint32_t header[2] = { static_cast<uint32_t>(engine), static_cast<uint32_t>(pattern.size()) };
+        for (const TWorker& w : _workers) {
+            if (!writeAll(w.socket, header, sizeof(header)) || !writeAll(w.socket, pattern.data(), pattern.size()))
+                throw std::runtime_error("Worker connection lost");
+        }
+        for (const TWorker& w : _workers) {
+            uint64_t count = 0;
+            if (!readAll(w.socket, &count, sizeof(count)))
+                throw std::runtime_error("Worker connection lost");
+            size_t first = positions.size();
+            positions.resize(first + count);
+            std::vector<uint64_t> local(count);
+            if (count > 0 && !readAll(w.socket, local.data(), count * sizeof(uint64_t)))
+                throw std::runtime_error("Worker connection lost");
+            for (size_t i = 0; i < count; ++i)
+                positions[first + i] = w.offset + local[i];
+        }
+    }
+
+    void shutdown() {
+        uint32_t stop[2] = { 0, 0 };
+        for (const TWorker& w : _workers) {
+            writeAll(w.socket, stop, sizeof(stop));
+            ::close(w.socket);
+        }
+        for (const TWorker& w : _workers) {
+            while (::waitpid(w.pid, nullptr, 0) < 0 && errno == EINTR) {
+            }
+        }
+        _workers.clear();
+    }
+
+    static bool writeAll(int fd, const void* data, size_t length) {
+        const char* p = static_cast<const char*>(data);
+        while (length > 0) {
+#ifdef MSG_NOSIGNAL
+            ssize_t done = ::send(fd, p, length, MSG_NOSIGNAL);
+#else
+            ssize_t done = ::write(fd, p, length);
+#endif
+            if (done < 0 && errno == EINTR)
+                continue;
+            if (done <= 0)
+                return false;
+            p += done;
+            length -= static_cast<size_t>(done);
+        }
+        return true;
+    }
+
+    static bool readAll(int fd, void* data, size_t length) {
+        char* p = static_cast<char*>(data);
+        while (length > 0) {
+            ssize_t done = ::read(fd, p, length);
+            if (done < 0 && errno == EINTR)
+                continue;
+            if (done <= 0)
+                return false;
+            p += done;
+            length -= static_cast<size_t>(done);
+        }
+        return true;
+    }
+
+    // Worker loop: maps `mapped` bytes at `start` (the own shard plus the
+    // overlap) and answers queries until told to stop; returns the exit code
+    static int serve(int socket, const std::string& path, size_t start, size_t own, size_t mapped) {
+#ifndef MSG_NOSIGNAL
+        ::signal(SIGPIPE, SIG_IGN);
+#endif
+        const char* shard = nullptr;
+        void* mapping = MAP_FAILED;
+        size_t skew = 0;
+        if (mapped > 0) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return 1;
+            // mmap offsets must be page aligned
+            size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            skew = start % page;
+            mapping = ::mmap(nullptr, mapped + skew, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(start - skew));
+            ::close(fd);
+            if (mapping == MAP_FAILED)
+                return 1;
+            ::madvise(mapping, mapped + skew, MADV_SEQUENTIAL);
+            shard = static_cast<const char*>(mapping) + skew;
+        }
+        std::string_view text(shard, mapped);
+
+        std::string pattern;
+        std::vector<uint64_t> found;
+        for (;;) {
+            uint32_t header[2];
+            if (!readAll(socket, header, sizeof(header)) || header[1] == 0)
+                break;
+            pattern.resize(header[1]);
+            if (!readAll(socket, &pattern[0], pattern.size()))
+                break;
+
+            found.clear();
+            auto report = [&](size_t i) {
+                if (i < own)
+                    found.push_back(i);
+            };
+            if (static_cast<TShardEngine>(header[0]) == TShardEngine::Filter)
+                byteScan<false>(text, pattern, report);
+            else
+                compactKmp(text, pattern, report);
+
+            uint64_t count = found.size();
+            if (!writeAll(socket, &count, sizeof(count)) || !writeAll(socket, found.data(), found.size() * sizeof(uint64_t)))
+                break;
+        }
+
+        if (mapping != MAP_FAILED)
+            ::munmap(mapping, mapped + skew);
+        ::close(socket);
+        return 0;
+    }
+};
+
+#endif  // _WIN32
+
+#endif  // INCLUDE_SHARDED_SEARCH_H_
@@ -0,0 +1,255 @@
+#ifndef INCLUDE_SUFFIX_AUTOMATON_H_
+#define INCLUDE_SUFFIX_AUTOMATON_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Online suffix automaton of a growing text. append() costs amortized O(1)
+// per character; existence, occurrence count and first occurrence of any
+// pattern can be asked between appends in O(m) (the first count query after
+// an append recomputes the counts in O(n)).
+//
+// Transitions are not kept in per-state maps: every state owns a slice of two
+// shared arrays (labels and targets) sorted by label. A slice has power-of-two
+// capacity and moves to the end of the arrays when it fills up; the holes this
+// leaves are squeezed out once they outnumber the slots in use.
+class TSuffixAutomaton {
+public:
+    TSuffixAutomaton() : _textSize(0), _last(0), _slotsInUse(0), _countsDirty(true) {
+        _states.push_back({ 0, NONE, 0, 0, 0, 0, 0 });
+    }
+
+    void append(const std::string& text) {
+        for (char c : text) {
+            append(c);
+        }
+    }
+
+    void append(char symbol) {
+        unsigned char c = static_cast<unsigned char>(symbol);
+        uint32_t cur = static_cast<uint32_t>(_states.size());
+        _states.push_back({ _states[_last].len + 1, NONE, static_cast<uint32_t>(_textSize), 0, 0, 0, 0 });
+        ++_textSize;
+        _countsDirty = true;
+
+        uint32_t p = _last;
+        while (p != NONE && findEdge(p, c) == NONE) {
+            addEdge(p, c, cur);
+            p = _states[p].link;
+        }
+
+        if (p == NONE) {
+            _states[cur].link = 0;
+        }
+        else {
+            uint32_t q = _targets[findEdge(p, c)];
+            if (_states[p].len + 1 == _states[q].len) {
+                _states[cur].link = q;
+            }
+            else {
+                uint32_t clone = static_cast<uint32_t>(_states.size());
+                TState copy = _states[q];
+                copy.len = _states[p].len + 1;
+                copy.isClone = 1;
+                copy.edgeCount = 0;
+                copy.edgeBegin = 0;
+                _states.push_back(copy);
+                copyEdges(q, clone);
+
+                while (p != NONE) {
+                    uint32_t edge = findEdge(p, c);
+                    if (edge == NONE || _targets[edge] != q) {
+                        break;
+                    }
+                    _targets[edge] = clone;
+                    p = _states[p].link;
+                }
+                _states[q].link = clone;
+                _states[cur].link = clone;
+            }
+        }
+        _last = cur;
+
+        if (_labels.size() > 2 * _slotsInUse + 1024) {
+            compact();
+        }
+    }
+
+    // Length of the text appended so far
+    size_t size() const noexcept {
+        return _textSize;
+    }
+
+    size_t states() const noexcept {
+        return _states.size();
+    }
+
+    bool contains(const std::string& pattern) const {
+        return !pattern.empty() && walk(pattern) != NONE;
+    }
+
+    // Number of (possibly overlapping) occurrences of the pattern
+    size_t count(const std::string& pattern) {
+        uint32_t state = pattern.empty() ? NONE : walk(pattern);
+        if (state == NONE) {
+            return 0;
+        }
+        if (_countsDirty) {
+            computeCounts();
+        }
+        return _counts[state];
+    }
+
+    // Offset of the leftmost occurrence, or -1 if there is none
+    long long firstOccurrence(const std::string& pattern) const {
+        uint32_t state = pattern.empty() ? NONE : walk(pattern);
+        if (state == NONE) {
+            return -1;
+        }
+        return static_cast<long long>(_states[state].firstEnd) - static_cast<long long>(pattern.size()) + 1;
+    }
+
+    // Bytes held by the automaton (allocated capacity, counts included)
+    size_t memoryUsage() const noexcept {
+        return _states.capacity() * sizeof(TState) + _labels.capacity() * sizeof(unsigned char)
+            + _targets.capacity() * sizeof(uint32_t) + _counts.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    struct TState {
+        uint32_t len;        // length of the longest string in the state
+        uint32_t link;       // suffix link
+        uint32_t firstEnd;   // end offset of the first occurrence
+        uint32_t edgeBegin;  // start of the edge slice in _labels/_targets
+        uint16_t edgeCount;
+        uint8_t isClone;
+        uint8_t reserved;
+    };
+
+    std::vector<TState> _states;
+    std::vector<unsigned char> _labels;
+    std::vector<uint32_t> _targets;
+    std::vector<uint32_t> _counts;
+    size_t _textSize;
+    uint32_t _last;
+    size_t _slotsInUse;  // sum of the slice capacities, holes excluded
+    bool _countsDirty;
+
+    // Slices are allocated in powers of two, so the capacity follows from the count
+    static size_t capacityFor(size_t count) {
+        size_t capacity = 1;
+        while (capacity < count)
+            capacity <<= 1;
+        return count == 0 ? 0 : capacity;
+    }
+
+    // Index of the edge with the given label in the shared arrays, or NONE
+    uint32_t findEdge(uint32_t state, unsigned char c) const {
+        const TState& s = _states[state];
+        const unsigned char* begin = _labels.data() + s.edgeBegin;
+        const unsigned char* end = begin + s.edgeCount;
+        const unsigned char* it = std::lower_bound(begin, end, c);
+        if (it == end || *it != c) {
+            return NONE;
+        }
+        return static_cast<uint32_t>(s.edgeBegin + (it - begin));
+    }
+
+    void addEdge(uint32_t state, unsigned char c, uint32_t target) {
+        TState& s = _states[state];
+        if (s.edgeCount == capacityFor(s.edgeCount)) {
+            size_t capacity = std::max<size_t>(1, 2 * s.edgeCount);
+            _slotsInUse += capacity - s.edgeCount;
+            uint32_t begin = static_cast<uint32_t>(_labels.size());
+            _labels.resize(begin + capacity);
+            _targets.resize(begin + capacity);
+            std::copy(_labels.begin() + s.edgeBegin, _labels.begin() + s.edgeBegin + s.edgeCount, _labels.begin() + begin);
+            std::copy(_targets.begin() + s.edgeBegin, _targets.begin() + s.edgeBegin + s.edgeCount, _targets.begin() + begin);
+            s.edgeBegin = begin;
+        }
+        // Insertion keeps the slice sorted by label
+        size_t i = s.edgeBegin + s.edgeCount;
+        while (i > s.edgeBegin && _labels[i - 1] > c) {
+            _labels[i] = _labels[i - 1];
+            _targets[i] = _targets[i - 1];
+            --i;
+        }
+        _labels[i] = c;
+        _targets[i] = target;
+        ++s.edgeCount;
+    }
+
+    void copyEdges(uint32_t from, uint32_t to) {
+        size_t count = _states[from].edgeCount;
+        uint32_t begin = static_cast<uint32_t>(_labels.size());
+        _labels.resize(begin + capacityFor(count));
+        _targets.resize(begin + capacityFor(count));
+        uint32_t source = _states[from].edgeBegin;
+        std::copy(_labels.begin() + source, _labels.begin() + source + count, _labels.begin() + begin);
+        std::copy(_targets.begin() + source, _targets.begin() + source + count, _targets.begin() + begin);
+        _states[to].edgeBegin = begin;
+        _states[to].edgeCount = static_cast<uint16_t>(count);
+        _slotsInUse += capacityFor(count);
+    }
+
+    // Rewrites the edge arrays without the holes left by moved slices
+    void compact() {
+        std::vector<unsigned char> labels;
+        std::vector<uint32_t> targets;
+        labels.reserve(_slotsInUse);
+        targets.reserve(_slotsInUse);
+        for (TState& s : _states) {
+            uint32_t begin = static_cast<uint32_t>(labels.size());
+            labels.insert(labels.end(), _labels.begin() + s.edgeBegin, _labels.begin() + s.edgeBegin + s.edgeCount);
+            targets.insert(targets.end(), _targets.begin() + s.edgeBegin, _targets.begin() + s.edgeBegin + s.edgeCount);
+            labels.resize(begin + capacityFor(s.edgeCount));
+            targets.resize(begin + capacityFor(s.edgeCount));
+            s.edgeBegin = begin;
+        }
+        _labels.swap(labels);
+        _targets.swap(targets);
+    }
+
+    uint32_t walk(const std::string& pattern) const {
+        uint32_t state = 0;
+        for (char c : pattern) {
+            uint32_t edge = findEdge(state, static_cast<unsigned char>(c));
+            if (edge == NONE) {
+                return NONE;
+            }
+            state = _targets[edge];
+        }
+        return state;
+    }
+
+    // Every non-clone state ends one prefix of the text; a state occurs as many
+    // times as there are such states in its suffix-link subtree. States are
+    // visited by decreasing len (counting sort) so children come before parents.
+    void computeCounts() {
+        size_t maxLen = _textSize;
+        std::vector<uint32_t> bucket(maxLen + 2, 0);
+        for (const TState& s : _states)
+            ++bucket[s.len];
+        for (size_t len = 1; len <= maxLen; ++len)
+            bucket[len] += bucket[len - 1];
+        std::vector<uint32_t> order(_states.size());
+        for (uint32_t i = static_cast<uint32_t>(_states.size()); i-- > 0;)
+            order[--bucket[_states[i].len]] = i;
+
+        _counts.assign(_states.size(), 0);
+        for (size_t i = 1; i < _states.size(); ++i)
+            _counts[i] = _states[i].isClone ? 0 : 1;
+        for (size_t i = order.size(); i-- > 1;) {
+            uint32_t state = order[i];
+            _counts[_states[state].link] += _counts[state];
+        }
+        _countsDirty = false;
+    }
+};
+
+#endif  // INCLUDE_SUFFIX_AUTOMATON_H_
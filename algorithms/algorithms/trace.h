@@ -0,0 +1,194 @@
+#ifndef INCLUDE_TRACE_H_
+#define INCLUDE_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Phase-level tracing in the Chrome trace-event format (open the file in
+// Perfetto or chrome://tracing).
+//
+// Tracing is switched on by setting ALGORITHMS_TRACE to the output path; the
+// file is written when the program exits. When it is off every scope costs
+// one test of a cached flag, and defining ALGORITHMS_NO_TRACE removes even
+// that. The phases used across the searchers are load, preprocess, scan,
+// verify and emit.
+class TTracer {
+public:
+    using TClock = std::chrono::steady_clock;
+
+    static TTracer& instance() {
+        static TTracer tracer;
+        return tracer;
+    }
+
+    static bool enabled() {
+#ifdef ALGORITHMS_NO_TRACE
+        return false;
+#else
+        static const bool on = instance()._enabled;
+        return on;
+#endif
+    }
+
+    // Adds a complete ("ph":"X") event; args is a JSON object body such as "\"calls\": 3" or empty
+    void complete(const std::string& name, TClock::time_point begin, TClock::duration duration, const std::string& args = "") {
+        TEvent event;
+        event.name = name;
+        event.args = args;
+        event.begin = std::chrono::duration<double, std::micro>(begin - _start).count();
+        event.duration = std::chrono::duration<double, std::micro>(duration).count();
+        event.thread = threadIndex();
+        std::lock_guard<std::mutex> lock(_mutex);
+        _events.push_back(std::move(event));
+    }
+
+    // Writes the collected events; called again at exit, so it only has to be
+    // called by hand to look at a trace while the program still runs
+    void flush() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_enabled)
+            return;
+        FILE* out = std::fopen(_path.c_str(), "w");
+        if (!out)
+            return;
+        std::fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+        for (size_t i = 0; i < _events.size(); ++i) {
+            const TEvent& e = _events[i];
+            std::fprintf(out, "{\"name\": \"%s\", \"cat\": \"algorithms\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, "
+                              "\"ts\": %.3f, \"dur\": %.3f, \"args\": {%s}}%s\n",
+                         escape(e.name).c_str(), e.thread, e.begin, e.duration, e.args.c_str(),
+                         i + 1 < _events.size() ? "," : "");
+        }
+        std::fprintf(out, "]}\n");
+        std::fclose(out);
+    }
+
+    ~TTracer() {
+        flush();
+    }
+
+private:
+    struct TEvent {
+        std::string name;
+        std::string args;
+        double begin;     // microseconds since the tracer started
+        double duration;  // microseconds
+        unsigned thread;
+    };
+
+    bool _enabled;
+    std::string _path;
+    TClock::time_point _start;
+    std::mutex _mutex;
+    std::vector<TEvent> _events;
+
+    TTracer() : _start(TClock::now()) {
+        const char* path = std::getenv("ALGORITHMS_TRACE");
+        _enabled = path != nullptr && *path != '\0';
+        if (_enabled)
+            _path = path;
+    }
+
+    // Small sequential thread numbers read better in the viewer than native ids
+    static unsigned threadIndex() {
+        static std::atomic<unsigned> next(1);
+        thread_local unsigned index = next++;
+        return index;
+    }
+
+    static std::string escape(const std::string& s) {
+        std::string result;
+        for (char c : s) {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20)
+                result += c;
+        }
+        return result;
+    }
+};
+
+// Records the lifetime of the scope as one event
+class TTraceScope {
+public:
+    explicit TTraceScope(const char* name) : _enabled(TTracer::enabled()) {
+        if (_enabled) {
+            _name = name;
+            _begin = TTracer::TClock::now();
+        }
+    }
+
+    explicit TTraceScope(const std::string& name) : _enabled(TTracer::enabled()) {
+        if (_enabled) {
+            _name = name;
+            _begin = TTracer::TClock::now();
+        }
+    }
+
+    TTraceScope(const TTraceScope&) = delete;
+    TTraceScope& operator=(const TTraceScope&) = delete;
+
+    ~TTraceScope() {
+        if (_enabled)
+            TTracer::instance().complete(_name, _begin, TTracer::TClock::now() - _begin);
+    }
+
+private:
+    bool _enabled;
+    std::string _name;
+    TTracer::TClock::time_point _begin;
+};
+
+// Sums many short intervals of one phase that interleave with another, e.g.
+// verifying hash hits during a Rabin-Karp scan, where an event per interval
+// would cost more than the work itself. On destruction the total is recorded
+// as a single event that starts with the enclosing scope, with the number of
+// intervals in its args.
+class TTraceTotal {
+public:
+    explicit TTraceTotal(const char* name) : _enabled(TTracer::enabled()), _name(name), _total(0), _calls(0) {
+        if (_enabled)
+            _begin = TTracer::TClock::now();
+    }
+
+    TTraceTotal(const TTraceTotal&) = delete;
+    TTraceTotal& operator=(const TTraceTotal&) = delete;
+
+    void start() {
+        if (_enabled)
+            _started = TTracer::TClock::now();
+    }
+
+    void stop() {
+        if (_enabled) {
+            _total += TTracer::TClock::now() - _started;
+            ++_calls;
+        }
+    }
+
+    ~TTraceTotal() {
+        if (_enabled && _calls > 0)
+            TTracer::instance().complete(_name, _begin, _total, "\"calls\": " + std::to_string(_calls));
+    }
+
+private:
+    bool _enabled;
+    const char* _name;
+    TTracer::TClock::time_point _begin;
+    TTracer::TClock::time_point _started;
+    TTracer::TClock::duration _total;
+    uint64_t _calls;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+// TRACE_SCOPE("scan"); - traces the rest of the enclosing block
+#define TRACE_SCOPE(name) TTraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#endif  // INCLUDE_TRACE_H_
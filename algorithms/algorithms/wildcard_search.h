@@ -0,0 +1,275 @@
+#ifndef INCLUDE_WILDCARD_SEARCH_H_
+#define INCLUDE_WILDCARD_SEARCH_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "trace.h"
+
+// Number-theoretic transform modulo a prime of the form c * 2^k + 1
+class TNtt {
+public:
+    // Butterflies of the first stages run block by block over this many
+    // elements (16 KB), so they stay in L1 instead of sweeping the array once per stage
+    static constexpr size_t BLOCK = 1 << 12;
+
+    TNtt(uint32_t prime, uint32_t root, size_t size)
+        : _prime(prime), _size(size), _roots(size), _inverseRoots(size), _reversed(size) {
+        // Twiddles of the stage with half-length len live in [len, 2 * len), so
+        // every stage reads its factors sequentially
+        for (size_t len = 1; len < size; len <<= 1) {
+            uint32_t w = power(root, (prime - 1) / (2 * len));
+            uint32_t wInverse = power(w, prime - 2);
+            uint32_t cur = 1, curInverse = 1;
+            for (size_t j = 0; j < len; ++j) {
+                _roots[len + j] = cur;
+                _inverseRoots[len + j] = curInverse;
+                cur = mul(cur, w);
+                curInverse = mul(curInverse, wInverse);
+            }
+        }
+        size_t bits = 0;
+        while ((size_t(1) << bits) < size)
+            ++bits;
+        for (size_t i = 0; i < size; ++i) {
+            _reversed[i] = bits == 0 ? 0 : static_cast<uint32_t>((_reversed[i >> 1] >> 1) | ((i & 1) << (bits - 1)));
+        }
+        _sizeInverse = power(static_cast<uint32_t>(size % prime), prime - 2);
+    }
+
+    size_t size() const noexcept {
+        return _size;
+    }
+
+    uint32_t prime() const noexcept {
+        return _prime;
+    }
+
+    void forward(std::vector<uint32_t>& a) const {
+        transform(a, _roots);
+    }
+
+    void inverse(std::vector<uint32_t>& a) const {
+        transform(a, _inverseRoots);
+        for (uint32_t& x : a)
+            x = mul(x, _sizeInverse);
+    }
+
+    uint32_t mul(uint32_t a, uint32_t b) const {
+        return static_cast<uint32_t>(static_cast<uint64_t>(a) * b % _prime);
+    }
+
+    uint32_t add(uint32_t a, uint32_t b) const {
+        uint32_t s = a + b;
+        return s >= _prime ? s - _prime : s;
+    }
+
+    uint32_t sub(uint32_t a, uint32_t b) const {
+        return a >= b ? a - b : a + _prime - b;
+    }
+
+private:
+    uint32_t _prime;
+    size_t _size;
+    std::vector<uint32_t> _roots;
+    std::vector<uint32_t> _inverseRoots;
+    std::vector<uint32_t> _reversed;
+    uint32_t _sizeInverse;
+
+    uint32_t power(uint32_t base, uint32_t exp) const {
+        uint32_t result = 1;
+        while (exp > 0) {
+            if (exp & 1)
+                result = mul(result, base);
+            base = mul(base, base);
+            exp >>= 1;
+        }
+        return result;
+    }
+
+    void butterflies(std::vector<uint32_t>& a, const std::vector<uint32_t>& roots,
+                     size_t from, size_t to, size_t len) const {
+        for (size_t i = from; i < to; i += 2 * len) {
+            for (size_t j = 0; j < len; ++j) {
+                uint32_t u = a[i + j];
+                uint32_t v = mul(a[i + j + len], roots[len + j]);
+                a[i + j] = add(u, v);
+                a[i + j + len] = sub(u, v);
+            }
+        }
+    }
+
+    void transform(std::vector<uint32_t>& a, const std::vector<uint32_t>& roots) const {
+        for (size_t i = 0; i < _size; ++i) {
+            if (i < _reversed[i])
+                std::swap(a[i], a[_reversed[i]]);
+        }
+        size_t block = std::min(BLOCK, _size);
+        for (size_t start = 0; start < _size; start += block) {
+            for (size_t len = 1; len < block; len <<= 1)
+                butterflies(a, roots, start, start + block, len);
+        }
+        for (size_t len = block; len < _size; len <<= 1)
+            butterflies(a, roots, 0, _size, len);
+    }
+};
+
+// Reference wildcard matcher: compares every window, skipping wildcard positions of the pattern.
+// Matches are appended to positions: a vector<int> or a TOccurrenceSet.
+template<typename Positions>
+void wildcardSearchNaiveInto(std::string_view text, std::string_view pattern, Positions& positions, char wildcard = '?') {
+    size_t n = text.size();
+    size_t m = pattern.size();
+    if (m == 0 || m > n) {
+        return;
+    }
+    for (size_t i = 0; i + m <= n; ++i) {
+        size_t j = 0;
+        while (j < m && (pattern[j] == wildcard || pattern[j] == text[i + j])) {
+            ++j;
+        }
+        if (j == m) {
+            positions.push_back(static_cast<int>(i));
+        }
+    }
+}
+
+inline std::vector<int> wildcardSearchNaive(std::string_view text, std::string_view pattern, char wildcard = '?') {
+    std::vector<int> positions;
+    wildcardSearchNaiveInto(text, pattern, positions, wildcard);
+    return positions;
+}
+
+// Wildcard matching by convolution. With w_j = 0 on wildcards and 1 elsewhere,
+// window i matches iff sum_j w_j * (p_j - t_{i+j})^2 = 0. The sum expands into
+// sum(w p^2) - 2 * (wp (*) t) + (w (*) t^2), two correlations computed with NTT.
+// The sum is below m * 256^2, so being zero modulo two primes whose product
+// exceeds that bound means it is exactly zero - the result has no false positives.
+// The text is processed in overlapping blocks of about 2m characters, so memory
+// stays O(m) and the running time is O(n log m). Patterns longer than the
+// transform sizes the primes allow (2^22) fall back to the direct scan.
+//
+// The transform tables and the transformed pattern are built once, so one
+// matcher can scan many texts (or pieces of one text) with the same pattern;
+// textLength sizes the transforms as a single scan of that many characters would.
+class TWildcardMatcher {
+public:
+    TWildcardMatcher(std::string_view pattern, size_t textLength, char wildcard = '?')
+        : _pattern(pattern), _wildcard(wildcard), _size(1), _naive(pattern.size() > (size_t(1) << 22)) {
+        size_t m = pattern.size();
+        if (m == 0 || _naive) {
+            return;
+        }
+        while (_size < std::max<size_t>(2 * m, std::min<size_t>(textLength + m, 1 << 16)))
+            _size <<= 1;
+
+        TRACE_SCOPE("preprocess");
+        const uint32_t primes[2] = { 998244353, 469762049 };  // both have primitive root 3
+        for (size_t k = 0; k < 2; ++k) {
+            _ntts.emplace_back(primes[k], 3, _size);
+            const TNtt& ntt = _ntts[k];
+            _weightedPattern[k].assign(_size, 0);
+            _weights[k].assign(_size, 0);
+            _patternSum[k] = 0;
+            for (size_t j = 0; j < m; ++j) {
+                if (pattern[j] == wildcard)
+                    continue;
+                uint32_t p = static_cast<unsigned char>(pattern[j]) + 1;
+                // Reversed so the correlation becomes a convolution
+                _weightedPattern[k][m - 1 - j] = p;
+                _weights[k][m - 1 - j] = 1;
+                _patternSum[k] = ntt.add(_patternSum[k], ntt.mul(p, p));
+            }
+            ntt.forward(_weightedPattern[k]);
+            ntt.forward(_weights[k]);
+        }
+    }
+
+    // Windows checked per transform; 0 for the direct scan
+    size_t step() const noexcept {
+        return _pattern.empty() || _naive ? 0 : _size - _pattern.size() + 1;
+    }
+
+    // Matches are appended to positions: a vector<int> or a TOccurrenceSet.
+    template<typename Positions>
+    void runInto(std::string_view text, Positions& positions) {
+        size_t n = text.size();
+        size_t m = _pattern.size();
+        if (m == 0 || m > n) {
+            return;
+        }
+        if (_naive) {
+            wildcardSearchNaiveInto(text, _pattern, positions, _wildcard);
+            return;
+        }
+
+        TRACE_SCOPE("scan");
+        size_t step = _size - m + 1;
+        _zero.resize(step);
+        _t.resize(_size);
+        _t2.resize(_size);
+        for (size_t start = 0; start + m <= n; start += step) {
+            size_t windows = std::min(step, n - m + 1 - start);
+            std::fill(_zero.begin(), _zero.end(), 1);
+
+            for (size_t k = 0; k < 2; ++k) {
+                const TNtt& ntt = _ntts[k];
+                for (size_t i = 0; i < _size; ++i) {
+                    uint32_t c = start + i < n ? static_cast<unsigned char>(text[start + i]) + 1 : 0;
+                    _t[i] = c;
+                    _t2[i] = c * c;
+                }
+                ntt.forward(_t);
+                ntt.forward(_t2);
+                uint32_t minusTwo = ntt.prime() - 2;
+                for (size_t i = 0; i < _size; ++i) {
+                    _t[i] = ntt.add(ntt.mul(ntt.mul(_t[i], _weightedPattern[k][i]), minusTwo),
+                                    ntt.mul(_t2[i], _weights[k][i]));
+                }
+                ntt.inverse(_t);
+                for (size_t i = 0; i < windows; ++i) {
+                    if (ntt.add(_t[i + m - 1], _patternSum[k]) != 0)
+                        _zero[i] = 0;
+                }
+            }
+
+            for (size_t i = 0; i < windows; ++i) {
+                if (_zero[i])
+                    positions.push_back(static_cast<int>(start + i));
+            }
+        }
+    }
+
+private:
+    std::string_view _pattern;
+    char _wildcard;
+    size_t _size;  // transform length
+    bool _naive;
+    std::vector<TNtt> _ntts;
+    std::vector<uint32_t> _weightedPattern[2];
+    std::vector<uint32_t> _weights[2];
+    uint32_t _patternSum[2];
+    // Scratch buffers of runInto, kept between calls
+    std::vector<char> _zero;
+    std::vector<uint32_t> _t;
+    std::vector<uint32_t> _t2;
+};
+
+template<typename Positions>
+void wildcardSearchInto(std::string_view text, std::string_view pattern, Positions& positions, char wildcard = '?') {
+    if (pattern.empty() || pattern.size() > text.size()) {
+        return;
+    }
+    TWildcardMatcher(pattern, text.size(), wildcard).runInto(text, positions);
+}
+
+inline std::vector<int> wildcardSearch(std::string_view text, std::string_view pattern, char wildcard = '?') {
+    std::vector<int> positions;
+    wildcardSearchInto(text, pattern, positions, wildcard);
+    return positions;
+}
+
+#endif  // INCLUDE_WILDCARD_SEARCH_H_
@@ -0,0 +1,159 @@
+#ifndef INCLUDE_WORK_STEALING_POOL_H_
+#define INCLUDE_WORK_STEALING_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool with one task deque per worker. A worker pops its own deque
+// from the back (newest first) and, when it runs dry, steals from the front
+// of the other deques, so tasks spawned by a busy worker get picked up by
+// idle ones.
+class TWorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit TWorkStealingPool(size_t threads = std::thread::hardware_concurrency())
+        : _queued(0), _pending(0), _nextQueue(0), _stopping(false) {
+        if (threads == 0)
+            threads = 1;
+        for (size_t i = 0; i < threads; ++i)
+            _queues.push_back(std::make_unique<TQueue>());
+        for (size_t i = 0; i < threads; ++i)
+            _workers.emplace_back(&TWorkStealingPool::run, this, i);
+    }
+
+    TWorkStealingPool(const TWorkStealingPool&) = delete;
+    TWorkStealingPool& operator=(const TWorkStealingPool&) = delete;
+
+    ~TWorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> guard(_sleepLock);
+            _stopping = true;
+        }
+        _wakeUp.notify_all();
+        for (std::thread& worker : _workers)
+            worker.join();
+    }
+
+    // Number of worker threads
+    size_t size() const noexcept {
+        return _workers.size();
+    }
+
+    // Queues a task. Called from a worker it goes to that worker's own deque,
+    // otherwise the deques are filled round-robin.
+    void submit(Task task) {
+        size_t index = (currentPool() == this) ? currentIndex()
+                                               : _nextQueue.fetch_add(1) % _queues.size();
+        _pending.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> guard(_queues[index]->lock);
+            _queues[index]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> guard(_sleepLock);
+            _queued.fetch_add(1);
+        }
+        _wakeUp.notify_one();
+    }
+
+    // Blocks until every submitted task (including tasks they submitted) has
+    // finished. Rethrows the first exception thrown by a task.
+    void wait() {
+        std::unique_lock<std::mutex> lock(_sleepLock);
+        _allDone.wait(lock, [this] { return _pending.load() == 0; });
+        if (_error) {
+            std::exception_ptr error = _error;
+            _error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    struct TQueue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<TQueue>> _queues;
+    std::vector<std::thread> _workers;
+    std::atomic<size_t> _queued;
+    std::atomic<size_t> _pending;
+    std::atomic<size_t> _nextQueue;
+    std::mutex _sleepLock;
+    std::condition_variable _wakeUp;
+    std::condition_variable _allDone;
+    std::exception_ptr _error;
+    bool _stopping;
+
+    static TWorkStealingPool*& currentPool() {
+        static thread_local TWorkStealingPool* pool = nullptr;
+        return pool;
+    }
+
+    static size_t& currentIndex() {
+        static thread_local size_t index = 0;
+        return index;
+    }
+
+    bool popLocal(size_t index, Task& task) {
+        TQueue& queue = *_queues[index];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.tasks.empty())
+            return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t index, Task& task) {
+        for (size_t k = 1; k < _queues.size(); ++k) {
+            TQueue& victim = *_queues[(index + k) % _queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(size_t index) {
+        currentPool() = this;
+        currentIndex() = index;
+        while (true) {
+            Task task;
+            if (popLocal(index, task) || steal(index, task)) {
+                _queued.fetch_sub(1);
+                try {
+                    task();
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> guard(_sleepLock);
+                    if (!_error)
+                        _error = std::current_exception();
+                }
+                if (_pending.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> guard(_sleepLock);
+                    _allDone.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(_sleepLock);
+            _wakeUp.wait(lock, [this] { return _stopping || _queued.load() > 0; });
+            if (_stopping && _queued.load() == 0)
+                return;
+        }
+    }
+};
+
+#endif  // INCLUDE_WORK_STEALING_POOL_H_
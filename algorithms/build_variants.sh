@@ -0,0 +1,43 @@
+#!/bin/sh
+# Builds both programs as Release, Release + LTO and Release + LTO + PGO and
+# reports the speedup of every variant over plain Release for each searcher.
+# Every variant runs interleaved with the release binary (exp --perf-gate),
+# on the held-out cases of the gate: the PGO training run executes the
+# regular cases, and timing on them would only show how well PGO fits its
+# training input. Release is also timed against itself as a control: its
+# row shows how far the machine alone moves the numbers.
+#
+#   ./build_variants.sh [build directory]    (default: build-variants)
+set -e
+cd "$(dirname "$0")"
+BUILD=${1:-build-variants}
+JOBS=$(nproc 2>/dev/null || echo 2)
+
+build() {
+    dir=$BUILD/$1
+    shift
+    cmake -S . -B "$dir" -DCMAKE_BUILD_TYPE=Release "$@" > /dev/null
+    cmake --build "$dir" -j "$JOBS" > /dev/null
+}
+
+echo "Building release"
+build release
+echo "Building lto"
+build lto -DALGORITHMS_LTO=ON
+
+echo "Building pgo: instrumented build and training run"
+rm -rf "$BUILD/pgo/pgo-profile"
+build pgo -DALGORITHMS_LTO=ON -DALGORITHMS_PGO=GENERATE
+cmake --build "$BUILD/pgo" --target pgo-train > /dev/null
+if ${CXX:-c++} --version | grep -qi clang; then
+    llvm-profdata merge -o "$BUILD/pgo/pgo-profile/default.profdata" "$BUILD/pgo/pgo-profile"/*.profraw
+fi
+echo "Building pgo: optimized with the profile"
+build pgo -DALGORITHMS_PGO=USE
+
+for variant in lto pgo release; do
+    echo
+    echo "== $variant against release"
+    # A slower variant makes the gate exit with 1; here that is only reported
+    "$BUILD/$variant/exp" --perf-gate --held-out "$BUILD/release/exp" || true
+done
@@ -4,13 +4,26 @@
 #include <random>
 #include <chrono>
 #include <fstream>
+#include <filesystem>
+
+#include "../algorithms/file_search.h"
+#include "../algorithms/wildcard_search.h"
+#include "../algorithms/compressed_text.h"
+#include "../algorithms/suffix_automaton.h"
+#include "../algorithms/occurrence_set.h"
+#include "../algorithms/rabin_karp_simd.h"
+#include "../algorithms/failure_table.h"
+#include "../algorithms/search_generator.h"
+#include "../algorithms/case_fold.h"
+#include "../algorithms/sharded_search.h"
+#include "../algorithms/trace.h"
+#include "../algorithms/perf_gate.h"
+#include "../algorithms/batch_search.h"
 
 //     
-std::string generate_random_string(size_t length, const std::string& alphabet) {
+std::string generate_random_string(size_t length, const std::string& alphabet, std::mt19937& gen) {
     std::string result;
     result.reserve(length);
-    std::random_device rd;
-    std::mt19937 gen(rd());
     std::uniform_int_distribution<> dist(0, alphabet.size() - 1);
 
     for (size_t i = 0; i < length; ++i) {
@@ -20,6 +33,12 @@ std::string generate_random_string(size_t length, const std::string& alphabet) {
     return result;
 }
 
+std::string generate_random_string(size_t length, const std::string& alphabet) {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    return generate_random_string(length, alphabet, gen);
+}
+
 //      
 std::string generate_pattern_string(const std::string& base, size_t k) {
     std::string result;
@@ -30,11 +49,22 @@ std::string generate_pattern_string(const std::string& base, size_t k) {
     return result;
 }
 
-void SFT_TRIVIAL(const std::string& X, const std::string& Y) {
+// Stores a match in the per-text int array
+inline void record_occurrence(std::vector<int>& f, size_t i) {
+    f[i] = i;
+}
+
+// Stores a match in the compact occurrence set
+inline void record_occurrence(TOccurrenceSet& f, size_t i) {
+    f.push_back(i);
+}
+
+template<typename Occurrences>
+void SFT_TRIVIAL_INTO(const std::string& X, const std::string& Y, Occurrences& f) {
     size_t m = X.size();
     size_t n = Y.size();
-    std::vector<int> f(m, -1);
 
+    TRACE_SCOPE("scan");
     for (size_t i = 0; i <= m - n; ++i) {
         size_t s = 0;
         while (s < n && Y[s] == X[i + s]) {
@@ -42,11 +72,16 @@ void SFT_TRIVIAL(const std::string& X, const std::string& Y) {
         }
 
         if (s == n) {
-            f[i] = i;
+            record_occurrence(f, i);
         }
     }
 }
 
+void SFT_TRIVIAL(const std::string& X, const std::string& Y) {
+    std::vector<int> f(X.size(), -1);
+    SFT_TRIVIAL_INTO(X, Y, f);
+}
+
 //  -   --
 void KMP(const std::string& Y, size_t n, std::vector<int>& fY) {
     size_t i = 1;
@@ -66,14 +101,17 @@ void KMP(const std::string& Y, size_t n, std::vector<int>& fY) {
     }
 }
 
-void SFT_KMP(const std::string& X, const std::string& Y) {
+template<typename Occurrences>
+void SFT_KMP_INTO(const std::string& X, const std::string& Y, Occurrences& f) {
     size_t m = X.size();
     size_t n = Y.size();
     std::vector<int> fY(n, 0);
-    KMP(Y, n, fY);
-
-    std::vector<int> f(m, -1);
+    {
+        TRACE_SCOPE("preprocess");
+        KMP(Y, n, fY);
+    }
 
+    TRACE_SCOPE("scan");
     size_t i = 0;
     size_t j = 0;
     while (i < m) {
@@ -86,32 +124,56 @@ void SFT_KMP(const std::string& X, const std::string& Y) {
         }
 
         if (j == n) {
-            f[i - n + 1] = i - n + 1;
+            record_occurrence(f, i - n + 1);
             j = fY[j - 1];
         }
         i++;
     }
 }
 
-std::vector<int> rabinKarp(const std::string& text, const std::string& pattern) {
-    std::vector<int> positions;
+void SFT_KMP(const std::string& X, const std::string& Y) {
+    std::vector<int> f(X.size(), -1);
+    SFT_KMP_INTO(X, Y, f);
+}
+
+// SFT_KMP with a failure table of adaptive width and period compression
+void SFT_KMP_COMPACT(const std::string& X, const std::string& Y) {
+    std::vector<int> f(X.size(), -1);
+    compactKmp(X, Y, [&](size_t i) { record_occurrence(f, i); });
+}
+
+// SFT_KMP_COMPACT without prefetching the failure links
+void SFT_KMP_COMPACT_NO_PREFETCH(const std::string& X, const std::string& Y) {
+    std::vector<int> f(X.size(), -1);
+    compactKmp<false>(X, Y, [&](size_t i) { record_occurrence(f, i); });
+}
+
+// Matches are appended to positions: a std::vector<int> or a TOccurrenceSet
+template<typename Positions>
+void rabinKarpInto(const std::string& text, const std::string& pattern, Positions& positions) {
     int m = pattern.size();
     int n = text.size();
     int base = 256;
     int prime = 101;
     int patternHash = 0, textHash = 0, h = 1;
 
-    for (int i = 0; i < m - 1; i++) {
-        h = (h * base) % prime;
-    }
+    {
+        TRACE_SCOPE("preprocess");
+        for (int i = 0; i < m - 1; i++) {
+            h = (h * base) % prime;
+        }
 
-    for (int i = 0; i < m; i++) {
-        patternHash = (base * patternHash + pattern[i]) % prime;
-        textHash = (base * textHash + text[i]) % prime;
+        for (int i = 0; i < m; i++) {
+            patternHash = (base * patternHash + static_cast<unsigned char>(pattern[i])) % prime;
+            textHash = (base * textHash + static_cast<unsigned char>(text[i])) % prime;
+        }
     }
 
+    TRACE_SCOPE("scan");
+    TTraceTotal verify("verify");
     for (int i = 0; i <= n - m; i++) {
         if (patternHash == textHash) {
+            verify.start();
             bool match = true;
             for (int j = 0; j < m; j++) {
                 if (text[i + j] != pattern[j]) {
@@ -119,17 +181,23 @@ std::vector<int> rabinKarp(const std::string& text, const std::string& pattern)
                     break;
                 }
             }
+            verify.stop();
             if (match) {
                 positions.push_back(i);
             }
         }
         if (i < n - m) {
-            textHash = (base * (textHash - text[i] * h) + text[i + m]) % prime;
+            textHash = (base * (textHash - static_cast<unsigned char>(text[i]) * h) + static_cast<unsigned char>(text[i + m])) % prime;
             if (textHash < 0) {
                 textHash += prime;
             }
         }
     }
+}
+
+std::vector<int> rabinKarp(const std::string& text, const std::string& pattern) {
+    std::vector<int> positions;
+    rabinKarpInto(text, pattern, positions);
     return positions;
 }
 
@@ -139,6 +207,7 @@ double measure_time(Func func, const std::string& X, const std::string& Y) {
     double total_duration = 0;
 
     for (size_t i = 0; i < iterations; ++i) {
+        TRACE_SCOPE("measure");
         auto start = std::chrono::high_resolution_clock::now();
         func(X, Y);  //   X  Y
         auto end = std::chrono::high_resolution_clock::now();
@@ -273,6 +342,803 @@ void experiment_4_3() {
     write_experiment_to_file("experiment_4_3_results.txt", T1_values, T2_values, T3_values);
 }
 
+// Writes a file of the given size made of random letters of the alphabet
+void write_random_file(const std::string& filename, size_t length, const std::string& alphabet) {
+    std::ofstream out(filename, std::ios::binary);
+    std::string text = generate_random_string(length, alphabet);
+    out.write(text.data(), text.size());
+}
+
+// Skewed file sizes: one huge file, a few medium ones and many small ones.
+// Compares a sequential scan with the work-stealing pool with and without
+// splitting large files into chunks, for 1..hardware_concurrency threads.
+void experiment_multi_file() {
+    namespace fs = std::filesystem;
+    std::string alphabet = "ab";
+    std::string Y = "abbabbaab";
+    fs::path dir = fs::temp_directory_path() / "multi_file_experiment";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "medium");
+    fs::create_directories(dir / "small");
+
+    write_random_file((dir / "huge.txt").string(), 64 << 20, alphabet);
+    for (size_t i = 0; i < 8; ++i) {
+        write_random_file((dir / "medium" / (std::to_string(i) + ".txt")).string(), 4 << 20, alphabet);
+    }
+    for (size_t i = 0; i < 256; ++i) {
+        write_random_file((dir / "small" / (std::to_string(i) + ".txt")).string(), 16 << 10, alphabet);
+    }
+    std::vector<std::string> files = collectFiles({ dir.string() });
+
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t sequential_matches = 0;
+    for (const std::string& file : files) {
+        std::ifstream in(file, std::ios::binary);
+        std::string X((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        sequential_matches += rabinKarp(X, Y).size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double time_sequential = std::chrono::duration<double>(end - start).count();
+    std::cout << "Sequential: " << time_sequential << "s, matches = " << sequential_matches << "\n";
+
+    std::ofstream out("experiment_multi_file_results.txt");
+    out << "threads\tT0 (Sequential)\tT1 (Per-file tasks)\tT2 (Per-file + chunk tasks)\n";
+    size_t max_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads <= max_threads; ++threads) {
+        TWorkStealingPool pool(threads);
+
+        start = std::chrono::high_resolution_clock::now();
+        searchFiles(files, Y, rabinKarp, pool, SIZE_MAX / 2);
+        end = std::chrono::high_resolution_clock::now();
+        double time_per_file = std::chrono::duration<double>(end - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        searchFiles(files, Y, rabinKarp, pool);
+        end = std::chrono::high_resolution_clock::now();
+        double time_chunked = std::chrono::duration<double>(end - start).count();
+
+        out << threads << "\t" << time_sequential << "\t" << time_per_file << "\t" << time_chunked << "\n";
+        std::cout << "threads = " << threads << ", T1 = " << time_per_file << "s, T2 = " << time_chunked << "s\n";
+    }
+
+    fs::remove_all(dir);
+}
+
+// Writes one row per parameter value with a column of timings for every algorithm
+void write_comparison_to_file(const std::string& filename, const std::string& header, const std::vector<size_t>& params, const std::vector<std::vector<double>>& columns) {
+    std::ofstream out(filename);
+    if (out.is_open()) {
+        out << header << "\n";
+        for (size_t i = 0; i < params.size(); ++i) {
+            out << params[i];
+            for (const std::vector<double>& column : columns) {
+                out << "\t" << column[i];
+            }
+            out << "\n";
+        }
+        out.close();
+    }
+    else {
+        std::cerr << "Unable to open file for writing: " << filename << "\n";
+    }
+}
+
+// Replaces every `every`-th character of the pattern with the wildcard '?'
+std::string with_wildcards(std::string Y, size_t every) {
+    for (size_t i = every - 1; i < Y.size(); i += every) {
+        Y[i] = '?';
+    }
+    return Y;
+}
+
+// Texts and patterns of one experiment series, generated from the varied parameter
+struct TShape {
+    std::string title;  // "4.1", printed before the series
+    std::string tag;    // "4_1", part of the result file name
+    std::string name;   // name of the parameter: "k", "m", "h"
+    size_t from;
+    size_t to;
+    size_t step;
+    std::string (*make_X)(size_t);
+    std::string (*make_Y)(size_t);
+};
+
+// Experiments 4.1-4.3 with a coarser step, shared by the comparisons below
+std::vector<TShape> experiment_shapes() {
+    return {
+        { "4.1", "4_1", "k", 1, 1001, 100,
+          [](size_t k) { return generate_pattern_string("ab", 1000 * k); },
+          [](size_t k) { return generate_pattern_string("ab", k); } },
+        { "4.2", "4_2", "m", 1, 1000000 + 1, 100000,
+          [](size_t) { return generate_random_string(1000000 + 1, "ab"); },
+          [](size_t m) { return generate_pattern_string("a", m); } },
+        { "4.3", "4_3", "h", 1, 1000000 + 1, 100000,
+          [](size_t h) { return generate_pattern_string("aaaaab", h); },
+          [](size_t) { return std::string("aaaaa"); } },
+    };
+}
+
+// Runs measure(X, Y, point) for every parameter value of the shape; measure
+// returns one value per column ("T1 (...)") and `point` ("k = 101") names the
+// value in error messages. Prints every row and writes experiment_<experiment>_<tag>_results.txt.
+template<typename Measure>
+void run_shape(const std::string& experiment, const TShape& shape, const std::vector<std::string>& columns, Measure measure) {
+    std::string title = experiment;
+    std::replace(title.begin(), title.end(), '_', ' ');
+    std::cout << "Running " << title << " experiment " << shape.title << "\n";
+    std::vector<size_t> params;
+    std::vector<std::vector<double>> values(columns.size());
+    std::string header = shape.name;
+    for (const std::string& column : columns) {
+        header += "\t" + column;
+    }
+
+    for (size_t k = shape.from; k <= shape.to; k += shape.step) {
+        std::string X = shape.make_X(k);
+        std::string Y = shape.make_Y(k);
+        std::string point = shape.name + " = " + std::to_string(k);
+        std::vector<double> row = measure(X, Y, point);
+
+        params.push_back(k);
+        std::cout << point;
+        for (size_t c = 0; c < columns.size(); ++c) {
+            values[c].push_back(row[c]);
+            std::cout << ", " << columns[c].substr(0, columns[c].find(' ')) << " = " << row[c];
+        }
+        std::cout << "\n";
+    }
+
+    write_comparison_to_file("experiment_" + experiment + "_" + shape.tag + "_results.txt", header, params, values);
+}
+
+// Shapes of experiments 4.1-4.3 with every fourth pattern character turned into a wildcard
+void experiment_wildcard() {
+    for (const TShape& shape : experiment_shapes()) {
+        run_shape("wildcard", shape, { "T1 (Naive wildcard)", "T2 (NTT wildcard)" },
+            [](const std::string& X, const std::string& exact, const std::string& point) -> std::vector<double> {
+                std::string Y = with_wildcards(exact, 4);
+                std::vector<int> naive, convolution;
+                double time_naive = measure_time([&](const std::string& a, const std::string& b) { naive = wildcardSearchNaive(a, b); }, X, Y);
+                double time_ntt = measure_time([&](const std::string& a, const std::string& b) { convolution = wildcardSearch(a, b); }, X, Y);
+                if (naive != convolution) {
+                    std::cerr << "Wildcard results differ for " << point << "\n";
+                }
+                return { time_naive, time_ntt };
+            });
+    }
+}
+
+// Experiments 4.1 and 4.3 on compressed texts: X is never materialized,
+// only its run-length encoding or its periodic view is built
+void experiment_compressed() {
+    std::vector<size_t> params;
+    std::vector<double> T1_values;
+    std::vector<double> T2_values;
+
+    std::cout << "Running compressed experiment 4.1\n";
+    for (size_t k = 1; k <= 1001; k += 10) {
+        std::string Y = generate_pattern_string("ab", k);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        TPeriodicString periodic("ab", 1000 * k);
+        size_t periodic_matches = searchPeriodic(periodic, Y).size();
+        auto end = std::chrono::high_resolution_clock::now();
+        double time_periodic = std::chrono::duration<double>(end - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        TRunLengthString encoded;
+        encoded.appendRepeated(TRunLengthString("ab"), 1000 * k);
+        size_t encoded_matches = searchRunLength(encoded, Y).size();
+        end = std::chrono::high_resolution_clock::now();
+        double time_encoded = std::chrono::duration<double>(end - start).count();
+
+        if (periodic_matches != encoded_matches) {
+            std::cerr << "Compressed results differ for k = " << k << "\n";
+        }
+
+        params.push_back(k);
+        T1_values.push_back(time_periodic);
+        T2_values.push_back(time_encoded);
+
+        std::cout << "k = " << k << ", T1 = " << time_periodic << "s, T2 = " << time_encoded << "s\n";
+    }
+    write_comparison_to_file("experiment_compressed_4_1_results.txt", "k\tT1 (Periodic view)\tT2 (Run-length)", params, { T1_values, T2_values });
+
+    params.clear();
+    T1_values.clear();
+    T2_values.clear();
+
+    std::cout << "Running compressed experiment 4.3\n";
+    for (size_t h = 1; h <= 1000000 + 1; h += 10000) {
+        std::string Y = "aaaaa";
+
+        auto start = std::chrono::high_resolution_clock::now();
+        TPeriodicString periodic("aaaaab", h);
+        size_t periodic_matches = searchPeriodic(periodic, Y).size();
+        auto end = std::chrono::high_resolution_clock::now();
+        double time_periodic = std::chrono::duration<double>(end - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        TRunLengthString encoded;
+        encoded.appendRepeated(TRunLengthString("aaaaab"), h);
+        size_t encoded_matches = searchRunLength(encoded, Y).size();
+        end = std::chrono::high_resolution_clock::now();
+        double time_encoded = std::chrono::duration<double>(end - start).count();
+
+        if (periodic_matches != encoded_matches) {
+            std::cerr << "Compressed results differ for h = " << h << "\n";
+        }
+
+        params.push_back(h);
+        T1_values.push_back(time_periodic);
+        T2_values.push_back(time_encoded);
+
+        std::cout << "h = " << h << ", T1 = " << time_periodic << "s, T2 = " << time_encoded << "s\n";
+    }
+    write_comparison_to_file("experiment_compressed_4_3_results.txt", "h\tT1 (Periodic view)\tT2 (Run-length)", params, { T1_values, T2_values });
+}
+
+// Grows a text by appends and compares answering a query from the suffix
+// automaton with rescanning the whole text; also reports bytes per text character
+void experiment_suffix_automaton() {
+    std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+    std::string Y = "abc";
+    const size_t chunk = 100000;
+    const size_t report_every = 500000;
+
+    TSuffixAutomaton automaton;
+    std::string X;
+    double append_time = 0;
+
+    std::vector<size_t> params;
+    std::vector<double> T1_values;
+    std::vector<double> T2_values;
+    std::vector<double> T3_values;
+    std::vector<double> T4_values;
+    std::vector<double> T5_values;
+
+    for (size_t n = chunk; n <= 5000000; n += chunk) {
+        std::string piece = generate_random_string(chunk, alphabet);
+        X += piece;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        automaton.append(piece);
+        auto end = std::chrono::high_resolution_clock::now();
+        append_time += std::chrono::duration<double>(end - start).count();
+
+        if (n % report_every != 0) {
+            continue;
+        }
+
+        // The first query after appends recounts occurrences in O(n), later ones only walk the pattern
+        size_t automaton_count = 0;
+        double time_first_query = measure_time([&](const std::string&, const std::string& b) { automaton_count = automaton.count(b); }, X, Y);
+        double time_query = measure_time([&](const std::string&, const std::string& b) { automaton_count = automaton.count(b); }, X, Y);
+        size_t rescan_count = 0;
+        double time_rescan = measure_time([&](const std::string& a, const std::string& b) { rescan_count = rabinKarp(a, b).size(); }, X, Y);
+        if (automaton_count != rescan_count) {
+            std::cerr << "Suffix automaton count differs for n = " << n << "\n";
+        }
+
+        double ns_per_char = append_time / n * 1e9;
+        double bytes_per_char = double(automaton.memoryUsage()) / n;
+
+        params.push_back(n);
+        T1_values.push_back(ns_per_char);
+        T2_values.push_back(bytes_per_char);
+        T3_values.push_back(time_first_query);
+        T4_values.push_back(time_query);
+        T5_values.push_back(time_rescan);
+
+        std::cout << "n = " << n << ", append = " << ns_per_char << "ns/char, memory = " << bytes_per_char << " bytes/char, T3 = " << time_first_query << "s, T4 = " << time_query << "s, T5 = " << time_rescan << "s\n";
+    }
+
+    write_comparison_to_file("experiment_suffix_automaton_results.txt", "n\tT1 (Append, ns/char)\tT2 (Bytes/char)\tT3 (First count after appends)\tT4 (Repeated count)\tT5 (RabinKarp rescan)", params, { T1_values, T2_values, T3_values, T4_values, T5_values });
+}
+
+// Shapes of experiments 4.1-4.3 with matches stored in an int array and in a TOccurrenceSet
+void experiment_occurrence_set() {
+    for (const TShape& shape : experiment_shapes()) {
+        run_shape("occurrence_set", shape, { "T1 (KMP, int array)", "T2 (KMP, occurrence set)", "T3 (1M rank queries)",
+                                             "T4 (1M select queries)", "M1 (int array, MB)", "M2 (occurrence set, MB)" },
+            [](const std::string& X, const std::string& Y, const std::string& point) -> std::vector<double> {
+                std::vector<int> f;
+                TOccurrenceSet occurrences;
+                double time_array = measure_time([&](const std::string& a, const std::string& b) {
+                    f.assign(a.size(), -1);
+                    SFT_KMP_INTO(a, b, f);
+                }, X, Y);
+                double time_set = measure_time([&](const std::string& a, const std::string& b) {
+                    occurrences = TOccurrenceSet();
+                    SFT_KMP_INTO(a, b, occurrences);
+                }, X, Y);
+
+                // "How many matches before offset x" and "where is the k-th match" a million times each
+                volatile size_t checksum = 0;
+                double time_rank = measure_time([&](const std::string& a, const std::string&) {
+                    for (size_t q = 0; q < 1000000; ++q) {
+                        checksum = checksum + occurrences.rank(q * 7919 % (a.size() + 1));
+                    }
+                }, X, Y);
+                double time_select = measure_time([&](const std::string&, const std::string&) {
+                    for (size_t q = 0; q < 1000000 && !occurrences.empty(); ++q) {
+                        checksum = checksum + occurrences.select(q * 7919 % occurrences.size());
+                    }
+                }, X, Y);
+                if (occurrences.size() != size_t(std::count_if(f.begin(), f.end(), [](int v) { return v >= 0; }))) {
+                    std::cerr << "Occurrence set size differs for " << point << "\n";
+                }
+
+                return { time_array, time_set, time_rank, time_select,
+                         f.capacity() * sizeof(int) / 1048576.0, occurrences.memoryUsage() / 1048576.0 };
+            });
+    }
+}
+
+// Shapes of experiments 4.1-4.3: serial rolling hash against the lane kernels
+void experiment_rabin_karp_simd() {
+    for (const TShape& shape : experiment_shapes()) {
+        run_shape("rabin_karp_simd", shape, { "T1 (RabinKarp)", "T2 (RabinKarp, 8 scalar lanes)", "T3 (RabinKarp, AVX2 lanes)" },
+            [](const std::string& X, const std::string& Y, const std::string& point) -> std::vector<double> {
+                std::vector<int> serial, lanes, simd;
+                double time_serial = measure_time([&](const std::string& a, const std::string& b) { serial = rabinKarp(a, b); }, X, Y);
+                double time_lanes = measure_time([&](const std::string& a, const std::string& b) { lanes = TRabinKarpLanes(a, b, false).run(); }, X, Y);
+                double time_simd = measure_time([&](const std::string& a, const std::string& b) { simd = rabinKarpSimd(a, b); }, X, Y);
+                if (serial != lanes || serial != simd) {
+                    std::cerr << "RabinKarp results differ for " << point << "\n";
+                }
+                return { time_serial, time_lanes, time_simd };
+            });
+    }
+}
+
+// Experiment 4.2 (patterns up to 1000001 characters) with the int failure
+// table of SFT_KMP against the compact table; also reports the table sizes
+void experiment_4_2_compact() {
+    std::string alphabet = "ab";
+    std::vector<size_t> params;
+    std::vector<double> T2_values;
+    std::vector<double> T4_values;
+    std::vector<double> B2_values;
+    std::vector<double> B4_values;
+
+    for (size_t m = 1; m <= 1000000 + 1; m += 10000) {
+        std::string Y = generate_pattern_string("a", m);
+        std::string X = generate_random_string(1000000 + 1, alphabet);
+
+        double time_kmp = measure_time(SFT_KMP, X, Y);
+        double time_compact = measure_time(SFT_KMP_COMPACT, X, Y);
+
+        double table_bytes = double(m * sizeof(int));
+        double compact_bytes = m <= UINT8_MAX ? double(TCompactFailureTable<uint8_t>(Y).memoryUsage())
+                             : m <= UINT16_MAX ? double(TCompactFailureTable<uint16_t>(Y).memoryUsage())
+                             : double(TCompactFailureTable<uint32_t>(Y).memoryUsage());
+
+        params.push_back(m);
+        T2_values.push_back(time_kmp);
+        T4_values.push_back(time_compact);
+        B2_values.push_back(table_bytes);
+        B4_values.push_back(compact_bytes);
+
+        std::cout << "m = " << m << ", T2 = " << time_kmp << "s, T4 = " << time_compact << "s, table = " << table_bytes << " -> " << compact_bytes << " bytes\n";
+    }
+
+    write_comparison_to_file("experiment_4_2_compact_results.txt", "m\tT2 (KMP Algorithm)\tT4 (KMP, compact table)\tB2 (Table bytes)\tB4 (Compact table bytes)",
+                             params, { T2_values, T4_values, B2_values, B4_values });
+}
+
+// Prefix of the Fibonacci word abaababaabaab...: not periodic (its smallest
+// period is above m / 2), but with borders at every Fibonacci length, so
+// failure chains from deep states are long
+std::string generate_fibonacci_string(size_t length) {
+    std::string previous = "a";
+    std::string current = "ab";
+    while (current.size() < length) {
+        std::string next = current + previous;
+        previous.swap(current);
+        current.swap(next);
+    }
+    return current.substr(0, length);
+}
+
+// Prefixes of Y of random lengths, each with its last character flipped:
+// the scan keeps climbing to deep states and falling back through the table
+std::string generate_prefix_text(const std::string& Y, size_t length) {
+    std::mt19937 gen(20240601);
+    std::uniform_int_distribution<size_t> dist(2, Y.size());
+    std::string result;
+    result.reserve(length + Y.size());
+    while (result.size() < length) {
+        result.append(Y, 0, dist(gen));
+        result.back() = result.back() == 'a' ? 'b' : 'a';
+    }
+    result.resize(length);
+    return result;
+}
+
+// Long patterns that nothing compresses, one per entry width (8, 16 and 32
+// bits): the whole table is stored, 4 MB as int at m = 1000001, and the scan
+// reads it at deep states. T5 turns the failure-link prefetch off.
+void experiment_4_2_compact_nonperiodic() {
+    const std::vector<size_t> lengths = { 200, 250, 20000, 60000, 250000, 500000, 1000000 + 1 };
+    for (const std::string kind : { "fibonacci", "random" }) {
+        std::vector<size_t> params;
+        std::vector<double> T2_values, T4_values, T5_values, B2_values, B4_values;
+
+        for (size_t m : lengths) {
+            std::mt19937 gen(20240601);
+            std::string Y = kind == "fibonacci" ? generate_fibonacci_string(m) : generate_random_string(m, "ab", gen);
+            std::string X = generate_prefix_text(Y, 16 * (1000000 + 1));
+
+            double time_kmp = measure_time(SFT_KMP, X, Y);
+            double time_compact = measure_time(SFT_KMP_COMPACT, X, Y);
+            double time_no_prefetch = measure_time(SFT_KMP_COMPACT_NO_PREFETCH, X, Y);
+
+            double table_bytes = double(m * sizeof(int));
+            double compact_bytes = m <= UINT8_MAX ? double(TCompactFailureTable<uint8_t>(Y).memoryUsage())
+                                 : m <= UINT16_MAX ? double(TCompactFailureTable<uint16_t>(Y).memoryUsage())
+                                 : double(TCompactFailureTable<uint32_t>(Y).memoryUsage());
+
+            params.push_back(m);
+            T2_values.push_back(time_kmp);
+            T4_values.push_back(time_compact);
+            T5_values.push_back(time_no_prefetch);
+            B2_values.push_back(table_bytes);
+            B4_values.push_back(compact_bytes);
+
+            std::cout << kind << ", m = " << m << ", T2 = " << time_kmp << "s, T4 = " << time_compact << "s, T5 = " << time_no_prefetch
+                      << "s, table = " << table_bytes << " -> " << compact_bytes << " bytes\n";
+        }
+
+        write_comparison_to_file("experiment_4_2_compact_" + kind + "_results.txt",
+                                 "m\tT2 (KMP Algorithm)\tT4 (KMP, compact table)\tT5 (KMP, compact table, no prefetch)\tB2 (Table bytes)\tB4 (Compact table bytes)",
+                                 params, { T2_values, T4_values, T5_values, B2_values, B4_values });
+    }
+}
+
+// Overhead of the coroutine search API against the batch functions on the shapes of experiments 4.1-4.3;
+// the engines without a timing column are checked for equal results
+void experiment_generator() {
+    for (const TShape& shape : experiment_shapes()) {
+        run_shape("generator", shape, { "T1 (KMP, batch)", "T2 (KMP, generator)", "T3 (KMP, generator, first 10)",
+                                        "T4 (RabinKarp SIMD, batch)", "T5 (RabinKarp SIMD, generator)", "T6 (Filter, batch)", "T7 (Filter, generator)",
+                                        "T8 (Wildcard NTT, batch)", "T9 (Wildcard NTT, generator)" },
+            [](const std::string& X, const std::string& Y, const std::string& point) -> std::vector<double> {
+                auto collect = [](const std::string& a, const std::string& b, TSearchEngine engine) {
+                    std::vector<int> positions;
+                    for (size_t pos : lazySearch(a, b, engine)) {
+                        positions.push_back(int(pos));
+                    }
+                    return positions;
+                };
+
+                std::vector<int> batch, lazy;
+                double time_kmp = measure_time([&](const std::string& a, const std::string& b) { batch = compactKnuthMorrisPratt(a, b); }, X, Y);
+                double time_kmp_lazy = measure_time([&](const std::string& a, const std::string& b) { lazy = collect(a, b, TSearchEngine::KnuthMorrisPratt); }, X, Y);
+                bool same = batch == lazy;
+                double time_first = measure_time([](const std::string& a, const std::string& b) {
+                    size_t taken = 0;
+                    for (size_t pos : lazySearch(a, b)) {
+                        (void)pos;
+                        if (++taken == 10) {
+                            break;
+                        }
+                    }
+                }, X, Y);
+
+                double time_karp = measure_time([&](const std::string& a, const std::string& b) { batch = rabinKarpSimd(a, b); }, X, Y);
+                double time_karp_lazy = measure_time([&](const std::string& a, const std::string& b) { lazy = collect(a, b, TSearchEngine::RabinKarp); }, X, Y);
+                same = same && batch == lazy;
+                double time_filter = measure_time([&](const std::string& a, const std::string& b) { batch = byteSearch(a, b, false); }, X, Y);
+                double time_filter_lazy = measure_time([&](const std::string& a, const std::string& b) { lazy = collect(a, b, TSearchEngine::Filter); }, X, Y);
+                same = same && batch == lazy;
+
+                double time_wildcard = measure_time([&](const std::string& a, const std::string& b) { batch = wildcardSearch(a, b); }, X, Y);
+                double time_wildcard_lazy = measure_time([&](const std::string& a, const std::string& b) { lazy = collect(a, b, TSearchEngine::Wildcard); }, X, Y);
+                same = same && batch == lazy;
+
+                same = same && collect(X, Y, TSearchEngine::IgnoreCase) == byteSearch(X, Y, true);
+                if (!same) {
+                    std::cerr << "Generator results differ for " << point << "\n";
+                }
+                return { time_kmp, time_kmp_lazy, time_first, time_karp, time_karp_lazy, time_filter, time_filter_lazy,
+                         time_wildcard, time_wildcard_lazy };
+            });
+    }
+}
+
+// Random text of `length` characters, each an UTF-8 sequence from the alphabet
+std::string generate_utf8_string(size_t length, const std::vector<std::string>& alphabet) {
+    std::string result;
+    result.reserve(length * 2);
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dist(0, alphabet.size() - 1);
+
+    for (size_t i = 0; i < length; ++i) {
+        result += alphabet[dist(gen)];
+    }
+
+    return result;
+}
+
+// Cost of folding case during the scan: the same filter-and-verify search with and without folding
+void experiment_case_fold() {
+    std::vector<TShape> shapes = {
+        { "on ASCII text", "ascii", "n", 1000000, 16000000, 3000000,
+          [](size_t n) { return generate_random_string(n, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ "); },
+          [](size_t) { return std::string("Error"); } },
+        { "on UTF-8 text", "utf8", "n", 1000000, 16000000, 3000000,
+          [](size_t n) { return generate_utf8_string(n, { "a", "E", "r", "o", " ", "\xD0\xBE", "\xD1\x88", "\xD0\x98", "\xE2\x80\x94" }); },
+          [](size_t) { return std::string("Error \xE2\x80\x94"); } },
+    };
+
+    for (const TShape& shape : shapes) {
+        run_shape("case_fold", shape,
+            { "T1 (case-sensitive)", "T2 (case-insensitive)", "T3 (UTF-8, case-insensitive)", "T4 (KMP)" },
+            [](const std::string& X, const std::string& Y, const std::string& point) -> std::vector<double> {
+                std::vector<int> exact;
+                std::vector<int> folded;
+                double time_exact = measure_time([&](const std::string& a, const std::string& b) { exact = byteSearch(a, b, false); }, X, Y);
+                double time_folded = measure_time([&](const std::string& a, const std::string& b) { folded = byteSearch(a, b, true); }, X, Y);
+                double time_utf8 = measure_time([](const std::string& a, const std::string& b) { utf8Search(a, b, true); }, X, Y);
+                double time_kmp = measure_time(SFT_KMP, X, Y);
+                if (folded.size() < exact.size()) {
+                    std::cerr << "Case-insensitive search lost matches for " << point << "\n";
+                }
+                return { time_exact, time_folded, time_utf8, time_kmp };
+            });
+    }
+}
+
+// Scaling of the multi-process search with the number of worker processes on one file
+void experiment_sharded() {
+#ifdef _WIN32
+    std::cout << "Sharded search needs fork and Unix-domain sockets\n";
+#else
+    namespace fs = std::filesystem;
+    const std::string Y = "abbabbaab";
+    const size_t queries = 5;
+    fs::path file = fs::temp_directory_path() / "sharded_experiment.txt";
+    write_random_file(file.string(), 128 << 20, "ab");
+
+    std::ifstream in(file, std::ios::binary);
+    std::string X((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    double time_single = measure_time([](const std::string& a, const std::string& b) { compactKnuthMorrisPratt(a, b); }, X, Y);
+    size_t expected = compactKnuthMorrisPratt(X, Y).size();
+    X.clear();
+    X.shrink_to_fit();
+    std::cout << "Single process: " << time_single << "s, matches = " << expected << "\n";
+
+    std::ofstream out("experiment_sharded_results.txt");
+    out << "workers\tT0 (Single process KMP)\tT1 (Start workers)\tT2 (First query, KMP)\tT3 (Query, KMP)\tT4 (Query, Filter)\n";
+    size_t max_workers = std::min(SHARDED_MAX_WORKERS, std::max<size_t>(4, std::thread::hardware_concurrency()));
+    for (size_t workers = 1; workers <= max_workers; ++workers) {
+        auto start = std::chrono::high_resolution_clock::now();
+        TShardedSearch sharded(file.string(), workers, Y.size());
+        auto end = std::chrono::high_resolution_clock::now();
+        double time_start = std::chrono::duration<double>(end - start).count();
+
+        // The first query also faults the mapped shards in
+        start = std::chrono::high_resolution_clock::now();
+        size_t found = sharded.search(Y).size();
+        end = std::chrono::high_resolution_clock::now();
+        double time_first = std::chrono::duration<double>(end - start).count();
+        if (found != expected) {
+            std::cerr << "Sharded search found " << found << " matches with " << workers << " workers\n";
+        }
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t q = 0; q < queries; ++q) {
+            sharded.search(Y);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double time_kmp = std::chrono::duration<double>(end - start).count() / queries;
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t q = 0; q < queries; ++q) {
+            sharded.search(Y, TShardEngine::Filter);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double time_filter = std::chrono::duration<double>(end - start).count() / queries;
+
+        out << workers << "\t" << time_single << "\t" << time_start << "\t" << time_first << "\t" << time_kmp << "\t" << time_filter << "\n";
+        std::cout << "workers = " << workers << ", T1 = " << time_start << "s, T2 = " << time_first << "s, T3 = " << time_kmp
+                  << "s, T4 = " << time_filter << "s\n";
+    }
+
+    fs::remove(file);
+#endif
+}
+
+// Many patterns against many documents: the nested loop that streams every
+// document once per pattern against the tiled batch search, for both engines
+void experiment_batch() {
+    std::mt19937 gen(7);
+    std::vector<std::string> documents;
+    const std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+    for (size_t d = 0; d < 64; ++d) {
+        documents.push_back(generate_random_string(1 << 20, alphabet, gen));
+    }
+    size_t max_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    TWorkStealingPool single(1);
+    TWorkStealingPool all(max_threads);
+
+    auto nested = [&](const std::vector<std::string>& patterns, TBatchEngine engine) {
+        size_t matches = 0;
+        for (const std::string& Y : patterns) {
+            for (const std::string& X : documents) {
+                if (engine == TBatchEngine::KnuthMorrisPratt) {
+                    compactKmp(X, Y, [&](size_t) { ++matches; });
+                }
+                else {
+                    byteScan<false>(X, Y, [&](size_t) { ++matches; });
+                }
+            }
+        }
+        return matches;
+    };
+
+    std::vector<size_t> params;
+    std::vector<std::vector<double>> columns(5);
+    for (size_t count = 4; count <= 32; count += 4) {
+        std::vector<std::string> patterns;
+        for (size_t k = 0; k < count; ++k) {
+            patterns.push_back(generate_random_string(8 + k % 25, alphabet, gen));
+        }
+        TPatternBatch batch(patterns);
+
+        std::vector<double> times;
+        size_t expected = 0;
+        for (TBatchEngine engine : { TBatchEngine::KnuthMorrisPratt, TBatchEngine::Filter }) {
+            auto start = std::chrono::high_resolution_clock::now();
+            expected = nested(patterns, engine);
+            auto end = std::chrono::high_resolution_clock::now();
+            times.push_back(std::chrono::duration<double>(end - start).count());
+
+            start = std::chrono::high_resolution_clock::now();
+            size_t found = batchSearch(documents, batch, single, engine).size();
+            end = std::chrono::high_resolution_clock::now();
+            times.push_back(std::chrono::duration<double>(end - start).count());
+            if (found != expected) {
+                std::cerr << "Batch search found " << found << " matches instead of " << expected << "\n";
+            }
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        batchSearch(documents, batch, all);
+        auto end = std::chrono::high_resolution_clock::now();
+        times.push_back(std::chrono::duration<double>(end - start).count());
+
+        params.push_back(count);
+        for (size_t c = 0; c < times.size(); ++c) {
+            columns[c].push_back(times[c]);
+        }
+        std::cout << "patterns = " << count << ", T1 = " << times[0] << "s, T2 = " << times[1] << "s, T3 = " << times[2]
+                  << "s, T4 = " << times[3] << "s, T5 = " << times[4] << "s\n";
+    }
+
+    write_comparison_to_file("experiment_batch_results.txt",
+                             "patterns\tT1 (KMP, nested loop)\tT2 (KMP, batch)\tT3 (Filter, nested loop)\tT4 (Filter, batch)\tT5 (Filter, batch, "
+                                 + std::to_string(max_threads) + " threads)",
+                             params, columns);
+}
+
+// Fixed points of experiments 4.1-4.3 timed by the performance gate
+struct TPerfCase {
+    std::string name;
+    std::string X;
+    std::string Y;
+};
+
+// The held-out set takes other points, periods and seed. The PGO training run
+// executes the regular set, so build variants are timed on the held-out one.
+std::vector<TPerfCase> make_perf_cases(bool held_out) {
+    std::mt19937 gen(held_out ? 20240917 : 20240601);  // fixed seed: the texts are the same on every run
+    std::vector<TPerfCase> cases;
+    if (!held_out) {
+        cases.push_back({ "4.1 k=101", generate_pattern_string("ab", 1000 * 101), generate_pattern_string("ab", 101) });
+        cases.push_back({ "4.2 m=10001", generate_random_string(1000000 + 1, "ab", gen), generate_pattern_string("a", 10001) });
+        cases.push_back({ "4.3 h=100001", generate_pattern_string("aaaaab", 100001), "aaaaa" });
+    }
+    else {
+        cases.push_back({ "4.1 k=151", generate_pattern_string("abb", 1000 * 151), generate_pattern_string("abb", 151) });
+        cases.push_back({ "4.2 m=20001", generate_random_string(1000000 + 1, "abc", gen), generate_pattern_string("b", 20001) });
+        cases.push_back({ "4.3 h=150001", generate_pattern_string("aaab", 150001), "aaa" });
+    }
+    return cases;
+}
+
+// Build that produced the gate's samples; the CMake build fills it in
+#ifndef PERF_BUILD
+#define PERF_BUILD "unspecified build"
+#endif
+
+// Mean time of one call, repeating the call until the sample spans at least
+// min_seconds: a single sub-millisecond call is dominated by timer resolution
+// and scheduling noise
+template<typename Func>
+double measure_time_at_least(Func func, const std::string& X, const std::string& Y, double min_seconds) {
+    size_t calls = 0;
+    double elapsed = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    do {
+        func(X, Y);
+        ++calls;
+        elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    } while (elapsed < min_seconds);
+    return elapsed / calls;
+}
+
+// One sample per case and algorithm from this process: after a warm-up call,
+// the median of three timings of at least 10 ms each. The gate takes its
+// samples from many such processes, so they are independent of each other.
+TPerfSamples collect_perf_samples(bool held_out) {
+    const double min_sample = 0.01;
+    std::vector<TPerfCase> cases = make_perf_cases(held_out);
+    TPerfSamples samples;
+    auto take = [&](const TPerfCase& c, const std::string& algorithm, auto func) {
+        func(c.X, c.Y);
+        std::vector<double> times;
+        for (int i = 0; i < 3; ++i) {
+            times.push_back(measure_time_at_least(func, c.X, c.Y, min_sample));
+        }
+        samples[{ c.name, algorithm }].push_back(medianOf(times));
+    };
+    for (const TPerfCase& c : cases) {
+        take(c, "Trivial", SFT_TRIVIAL);
+        take(c, "KMP", SFT_KMP);
+        take(c, "RabinKarp", rabinKarp);
+    }
+    return samples;
+}
+
+std::string perf_sample_command(const std::string& binary, bool held_out) {
+    return "\"" + binary + "\" --perf-sample" + (held_out ? " --held-out" : "");
+}
+
+// exp --perf-gate [--held-out] <baseline exp>
+// Times this binary against a baseline binary, built from the commit to compare
+// against, and returns 1 if any searcher got significantly slower. Both run
+// `rounds` times as separate processes, alternating which one goes first, so a
+// slow phase of the machine hits both sides alike. --held-out times the cases
+// the PGO training run does not execute.
+int run_perf_gate(const std::string& self, const std::string& baseline_binary, bool held_out) {
+    const size_t rounds = 15;
+    TPerfSamples baseline;
+    TPerfSamples current;
+    std::string baseline_build = "unspecified build";
+    std::string current_build = "unspecified build";
+
+    std::cout << "Running both binaries " << rounds << " times, interleaved\n";
+    for (size_t round = 0; round < rounds; ++round) {
+        for (size_t side = 0; side < 2; ++side) {
+            bool is_baseline = (side == 0) == (round % 2 == 0);
+            const std::string& binary = is_baseline ? baseline_binary : self;
+            if (!runPerfCommand(perf_sample_command(binary, held_out), is_baseline ? baseline : current,
+                                is_baseline ? &baseline_build : &current_build)) {
+                std::cerr << "Unable to take samples with " << binary << "\n";
+                return 2;
+            }
+        }
+    }
+    std::cout << "Baseline: " << baseline_build << " (" << baseline_binary << ")\n";
+    std::cout << "Current: " << current_build << " (" << self << ")\n";
+
+    std::vector<TPerfComparison> comparisons = comparePerf(baseline, current);
+    printPerfTable(std::cout, comparisons);
+
+    size_t slower = 0;
+    for (const TPerfComparison& c : comparisons) {
+        slower += c.slower;
+    }
+    if (slower > 0) {
+        std::cout << slower << " of " << comparisons.size() << " searcher runs are significantly slower than the baseline\n";
+        return 1;
+    }
+    std::cout << "No significant slowdowns\n";
+    return 0;
+}
+
 void run_experiments() {
     std::cout << "Running experiment 4.1\n";
     experiment_4_1();
@@ -284,12 +1150,45 @@ void run_experiments() {
     experiment_4_3();
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // exp --perf-sample [--held-out]: one round of samples on standard output, for --perf-gate
+    if (argc >= 2 && std::string(argv[1]) == "--perf-sample") {
+        bool held_out = argc == 3 && std::string(argv[2]) == "--held-out";
+        writePerfSamples(std::cout, collect_perf_samples(held_out), PERF_BUILD);
+        return std::cout ? 0 : 2;
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--perf-gate") {
+        bool held_out = false;
+        std::string baseline_binary;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--held-out") {
+                held_out = true;
+            }
+            else {
+                baseline_binary = arg;
+            }
+        }
+        if (baseline_binary.empty()) {
+            std::cerr << "Usage: exp --perf-gate [--held-out] <baseline exp binary>\n";
+            return 2;
+        }
+        return run_perf_gate(argv[0], baseline_binary, held_out);
+    }
+    // exp --write-corpus <path> <bytes>: seeded random text over "ab", e.g. for PGO training runs
+    if (argc == 4 && std::string(argv[1]) == "--write-corpus") {
+        std::mt19937 gen(20240601);
+        std::ofstream out(argv[2], std::ios::binary);
+        std::string text = generate_random_string(std::stoul(argv[3]), "ab", gen);
+        out.write(text.data(), text.size());
+        return out ? 0 : 2;
+    }
+
     int num;
-    std::cout << "Enter num 1. Run experiment 2. Create experiment\n";
+    std::cout << "Enter num 1. Run experiment 2. Create experiment 3. Run multi-file experiment 4. Run wildcard experiment 5. Run compressed experiment 6. Run suffix automaton experiment 7. Run occurrence set experiment 8. Run RabinKarp SIMD experiment 9. Run compact failure table experiment 10. Run generator experiment 11. Run case folding experiment 12. Run sharded experiment 13. Run batch experiment\n";
     std::cin >> num;
     if (num == 1) { run_experiments(); }
-    if (num == 2) {
+    else if (num == 2) {
         size_t alphabet_size;
         std::cout << "Enter the size of the alphabet: ";
         std::cin >> alphabet_size;
@@ -312,6 +1211,40 @@ int main() {
         std::cout << "Time for KMP algorithm: " << time_kmp << " seconds\n";
         std::cout << "Time for RabinKarp algorithm: " << time_karp << " seconds\n";
     }
+    else if (num == 3) {
+        experiment_multi_file();
+    }
+    else if (num == 4) {
+        experiment_wildcard();
+    }
+    else if (num == 5) {
+        experiment_compressed();
+    }
+    else if (num == 6) {
+        experiment_suffix_automaton();
+    }
+    else if (num == 7) {
+        experiment_occurrence_set();
+    }
+    else if (num == 8) {
+        experiment_rabin_karp_simd();
+    }
+    else if (num == 9) {
+        experiment_4_2_compact();
+        experiment_4_2_compact_nonperiodic();
+    }
+    else if (num == 10) {
+        experiment_generator();
+    }
+    else if (num == 11) {
+        experiment_case_fold();
+    }
+    else if (num == 12) {
+        experiment_sharded();
+    }
+    else if (num == 13) {
+        experiment_batch();
+    }
     else {
         std::cout << "Error";
         return 0;